@@ -0,0 +1,575 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    EchoChaosBench: headless render and throughput benchmark. Instantiates
+    Ek0Ka0sAudioProcessor without a host, loads a preset and/or parameter
+    values, streams synthetic or WAV input through processBlock for every
+    sample rate x block size in the matrix and reports ns/sample, realtime
+    factor and per-block time percentiles.
+
+    EchoChaosBench [options]
+        --preset <name>          preset of that name from the plugin's preset bank
+        --bank <file>            preset bank to read --preset from (default: the plugin's,
+                                 PresetBank::getDefaultFile)
+        --param <id>=<value>     set one parameter, in its real units; repeatable
+        --input <file.wav>       input signal, looped (default: noise + sweep)
+        --seconds <n>            audio rendered per configuration (default 10)
+        --blocks <a,b,...>       block sizes (default 16,32,...,4096)
+        --rates <a,b,...>        sample rates (default 44100,48000,88200,96000,176400,192000)
+        --seed <n>               LFO seed (default 1)
+        --out <dir>              write each rendered output as a WAV file
+        --trace <dir>            write a Chrome / Perfetto trace and a per-stage summary
+                                 of each configuration (needs ECHO_CHAOS_PROFILING=1,
+                                 as in the Profile configuration)
+        --baseline <file>        compare the ns/sample of every configuration with a recorded
+                                 baseline; exits with 1 when one is slower by more than --threshold
+        --threshold <percent>    slowdown --baseline accepts (default 10)
+        --golden <dir>           instead of benchmarking, render the regression suite (every
+                                 waveform, filter mode and I/O combination, delay, feedback and
+                                 LFO settings) and compare it with the golden WAVs in dir;
+                                 exits with 1 on a mismatch
+        --tolerance <x>          largest sample difference --golden accepts (default 1e-4)
+        --record                 write the baseline / the golden files instead of comparing
+        --offline                render as a non-realtime bounce (offline oversampling, lanes
+                                 spread over the worker pool)
+        --double                 process in double precision, as a 64-bit host does
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include "../Source/PluginProcessor.h"
+#include "../Source/Profiler.h"
+
+namespace
+{
+    struct Options
+    {
+        juce::String presetName;
+        juce::File bankFile = PresetBank::getDefaultFile();
+        juce::File inputFile, outputDirectory, traceDirectory, baselineFile, goldenDirectory;
+        juce::StringArray parameterValues;
+        double seconds = 10.0;
+        juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        juce::Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+        juce::int64 seed = 1;
+        double threshold = 10.0, tolerance = 1.0e-4;
+        bool record = false, offline = false, doublePrecision = false;
+    };
+
+    struct Result
+    {
+        double nsPerSample, realtimeFactor;
+        double p50, p90, p99, maxBlock;     // microseconds per block
+    };
+
+    //==============================================================================
+    template <typename Number>
+    juce::Array<Number> parseList(const juce::String& text)
+    {
+        juce::Array<Number> values;
+
+        for (auto& token : juce::StringArray::fromTokens(text, ",", {}))
+            values.add((Number) token.trim().getDoubleValue());
+
+        return values;
+    }
+
+    bool parseOptions(const juce::ArgumentList& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto arg = args[i].text;
+            const auto next = i + 1 < args.size() ? args[i + 1].text : juce::String();
+
+            if (arg == "--preset")          { options.presetName = next; ++i; }
+            else if (arg == "--bank")       { options.bankFile = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--param")      { options.parameterValues.add(next); ++i; }
+            else if (arg == "--input")      { options.inputFile = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--seconds")    { options.seconds = juce::jmax(0.1, next.getDoubleValue()); ++i; }
+            else if (arg == "--blocks")     { options.blockSizes = parseList<int>(next); ++i; }
+            else if (arg == "--rates")      { options.sampleRates = parseList<double>(next); ++i; }
+            else if (arg == "--seed")       { options.seed = next.getLargeIntValue(); ++i; }
+            else if (arg == "--out")        { options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--trace")      { options.traceDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--baseline")   { options.baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--threshold")  { options.threshold = juce::jmax(0.0, next.getDoubleValue()); ++i; }
+            else if (arg == "--golden")     { options.goldenDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--tolerance")  { options.tolerance = juce::jmax(0.0, next.getDoubleValue()); ++i; }
+            else if (arg == "--record")     { options.record = true; }
+            else if (arg == "--offline")    { options.offline = true; }
+            else if (arg == "--double")     { options.doublePrecision = true; }
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    bool applyParameters(Ek0Ka0sAudioProcessor& processor, const Options& options)
+    {
+        if (options.presetName.isNotEmpty())
+        {
+            // Read with the plugin's own bank format, so anything it saved loads here
+
+            std::vector<PresetBank::Preset> presets;
+            juce::FileInputStream stream(options.bankFile);
+
+            if (! stream.openedOk() || ! PresetBank::read(stream, presets))
+            {
+                std::cerr << "Can't read preset bank " << options.bankFile.getFullPathName() << std::endl;
+                return false;
+            }
+
+            const auto preset = std::find_if(presets.begin(), presets.end(),
+                                             [&](const PresetBank::Preset& p) { return p.name == options.presetName; });
+
+            if (preset == presets.end())
+            {
+                std::cerr << "No preset " << options.presetName << " in " << options.bankFile.getFullPathName() << std::endl;
+                return false;
+            }
+
+            for (auto* parameter : processor.getParameters())
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+                    for (const auto& d : Ek0Ka0s::descriptors)
+                        if (ranged->paramID == d.id)
+                            ranged->setValueNotifyingHost(ranged->convertTo0to1(preset->values[d.index]));
+        }
+
+        for (auto& assignment : options.parameterValues)
+        {
+            const auto id = assignment.upToFirstOccurrenceOf("=", false, false).trim();
+            const auto value = assignment.fromFirstOccurrenceOf("=", false, false).getFloatValue();
+
+            bool found = false;
+
+            for (auto* parameter : processor.getParameters())
+            {
+                if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter); ranged != nullptr && ranged->paramID == id)
+                {
+                    ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+                    found = true;
+                }
+            }
+
+            if (! found)
+            {
+                std::cerr << "Unknown parameter " << id << std::endl;
+                return false;
+            }
+        }
+
+        processor.setLfoSeed(options.seed);
+        return true;
+    }
+
+    // Noise plus a slow sine sweep, different on each channel
+    juce::AudioBuffer<float> createSyntheticInput(double sampleRate, int numSamples)
+    {
+        juce::AudioBuffer<float> input(2, numSamples);
+        juce::Random random(42);
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            auto* data = input.getWritePointer(channel);
+            double phase = 0.0;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double frequency = 100.0 + 4000.0 * i / numSamples + 50.0 * channel;
+                phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+                data[i] = 0.25f * (float) std::sin(phase) + 0.1f * (random.nextFloat() * 2.f - 1.f);
+            }
+        }
+
+        return input;
+    }
+
+    bool loadInput(const juce::File& file, juce::AudioBuffer<float>& input)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return false;
+
+        input.setSize(2, (int) reader->lengthInSamples);
+        reader->read(&input, 0, (int) reader->lengthInSamples, 0, true, true);
+        return true;
+    }
+
+    void writeOutput(const juce::File& file, const juce::AudioBuffer<float>& output, double sampleRate, int bitsPerSample = 24)
+    {
+        file.deleteFile();
+        auto stream = file.createOutputStream();
+
+        if (stream == nullptr)
+            return;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, (unsigned int) output.getNumChannels(), bitsPerSample, {}, 0));
+
+        if (writer != nullptr)
+        {
+            stream.release();   // now owned by the writer
+            writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+        }
+    }
+
+    // The profiler's timeline and stage summary of one configuration
+    void writeTrace(const juce::File& directory, const juce::String& name)
+    {
+       #if ECHO_CHAOS_PROFILING
+        const auto traceFile = directory.getChildFile("trace_" + name + ".json");
+        traceFile.deleteFile();
+
+        if (auto stream = traceFile.createOutputStream())
+            Profiler::writeChromeTrace(*stream);
+
+        directory.getChildFile("stages_" + name + ".txt").replaceWithText(Profiler::getSummary());
+       #else
+        juce::ignoreUnused(directory, name);
+       #endif
+    }
+
+    //==============================================================================
+    double percentile(std::vector<double>& sorted, double fraction)
+    {
+        const auto index = (size_t) juce::jlimit(0.0, (double) sorted.size() - 1.0, std::ceil(fraction * (double) sorted.size()) - 1.0);
+        return sorted[index];
+    }
+
+    // rendered, if given, receives the output
+    bool runConfiguration(const Options& options, const juce::AudioBuffer<float>* fileInput,
+                          double sampleRate, int blockSize, Result& result,
+                          juce::AudioBuffer<float>* rendered = nullptr)
+    {
+        Ek0Ka0sAudioProcessor processor;
+
+        if (! applyParameters(processor, options))
+            return false;
+
+        const int numSamples = juce::roundToInt(options.seconds * sampleRate);
+        const int numBlocks = (numSamples + blockSize - 1) / blockSize;
+
+        auto input = fileInput != nullptr ? *fileInput : createSyntheticInput(sampleRate, numSamples);
+        juce::AudioBuffer<float> output(2, options.outputDirectory != juce::File() || rendered != nullptr ? numBlocks * blockSize : 0);
+
+        juce::AudioBuffer<float> block(2, blockSize);
+        juce::AudioBuffer<double> doubleBlock(2, options.doublePrecision ? blockSize : 0);
+        juce::MidiBuffer midi;
+        std::vector<double> blockSeconds;
+        blockSeconds.reserve((size_t) numBlocks);
+
+        processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor.setNonRealtime(options.offline);
+        processor.setProcessingPrecision(options.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                 : juce::AudioProcessor::singlePrecision);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+       #if ECHO_CHAOS_PROFILING
+        Profiler::reset();
+       #endif
+
+        int inputPosition = 0;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int channel = 0; channel < 2; ++channel)   // loop the input, outside the timed region
+                for (int i = 0; i < blockSize; ++i)
+                    block.setSample(channel, i, input.getSample(channel, (inputPosition + i) % input.getNumSamples()));
+
+            inputPosition = (inputPosition + blockSize) % input.getNumSamples();
+
+            if (options.doublePrecision)
+                doubleBlock.makeCopyOf(block, true);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            if (options.doublePrecision)
+                processor.processBlock(doubleBlock, midi);
+            else
+                processor.processBlock(block, midi);
+
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            if (options.doublePrecision)
+                block.makeCopyOf(doubleBlock, true);
+
+            blockSeconds.push_back(juce::Time::highResolutionTicksToSeconds(end - start));
+
+            if (output.getNumSamples() > 0)
+                for (int channel = 0; channel < 2; ++channel)
+                    output.copyFrom(channel, b * blockSize, block, channel, 0, blockSize);
+        }
+
+        processor.releaseResources();
+
+        const double totalSeconds = std::accumulate(blockSeconds.begin(), blockSeconds.end(), 0.0);
+        const double renderedSamples = (double) numBlocks * blockSize;
+
+        std::sort(blockSeconds.begin(), blockSeconds.end());
+
+        result.nsPerSample = totalSeconds * 1.0e9 / renderedSamples;
+        result.realtimeFactor = (renderedSamples / sampleRate) / totalSeconds;
+        result.p50 = percentile(blockSeconds, 0.50) * 1.0e6;
+        result.p90 = percentile(blockSeconds, 0.90) * 1.0e6;
+        result.p99 = percentile(blockSeconds, 0.99) * 1.0e6;
+        result.maxBlock = blockSeconds.back() * 1.0e6;
+
+        const auto name = juce::String(juce::roundToInt(sampleRate)) + "_" + juce::String(blockSize);
+
+        if (output.getNumSamples() > 0)
+            writeOutput(options.outputDirectory.getChildFile("render_" + name + ".wav"), output, sampleRate);
+
+        if (options.traceDirectory != juce::File())
+            writeTrace(options.traceDirectory, name);
+
+        if (rendered != nullptr)
+            *rendered = output;
+
+        return true;
+    }
+
+    //==============================================================================
+    // Performance baseline: one "rate block ns/sample" line per configuration
+
+    juce::String configurationName(double sampleRate, int blockSize)
+    {
+        return juce::String(juce::roundToInt(sampleRate)) + " " + juce::String(blockSize);
+    }
+
+    std::map<juce::String, double> readBaseline(const juce::File& file)
+    {
+        std::map<juce::String, double> baseline;
+
+        for (auto& line : juce::StringArray::fromLines(file.loadFileAsString()))
+        {
+            const auto tokens = juce::StringArray::fromTokens(line, " ", {});
+
+            if (tokens.size() == 3)
+                baseline[tokens[0] + " " + tokens[1]] = tokens[2].getDoubleValue();
+        }
+
+        return baseline;
+    }
+
+    //==============================================================================
+    // Golden renders. Each case sets a few parameters (in --param syntax) on top of
+    // the defaults and renders the synthetic input at 48 kHz in 256 sample blocks.
+
+    struct GoldenCase
+    {
+        juce::String name;
+        juce::StringArray parameterValues;
+    };
+
+    std::vector<GoldenCase> createGoldenSuite()
+    {
+        std::vector<GoldenCase> suite;
+
+        const juce::StringArray echo { "sendmid=0.5", "timemid=4800", "feedbackmid=0.5",
+                                       "sendside=0.5", "timeside=7200", "feedbackside=0.4" };
+
+        // Every LFO waveform, modulating time and cutoff
+
+        for (int waveform = 0; waveform < (int) std::size(Ek0Ka0s::waveformChoices); ++waveform)
+        {
+            GoldenCase test { "lfo_" + juce::String(waveform), echo };
+            test.parameterValues.addArray(juce::StringArray("lfospeedmid=2", "lfodepthmid=1000", "lfocutoffmid=1",
+                                                            "lfospeedside=3", "lfodepthside=500", "lfocutoffside=2",
+                                                            "cutoffmid=2000", "cutoffside=2000",
+                                                            "waveformmid=" + juce::String(waveform), "waveformside=" + juce::String(waveform)));
+            suite.push_back(test);
+        }
+
+        // Every filter mode, resonant
+
+        for (int mode = 0; mode < (int) std::size(Ek0Ka0s::filterChoices); ++mode)
+            suite.push_back({ "filter_" + juce::String(mode),
+                              juce::StringArray("cutoffmid=1000", "resonancemid=0.6", "modemid=" + juce::String(mode),
+                                                "cutoffside=3000", "resonanceside=0.3", "modeside=" + juce::String(mode)) });
+
+        // Every input and output type, with widening
+
+        for (int input = 0; input < 2; ++input)
+        {
+            for (int output = 0; output < 2; ++output)
+            {
+                GoldenCase test { "io_" + juce::String(input) + juce::String(output), echo };
+                test.parameterValues.addArray(juce::StringArray("stereowidth=1.6", "input=" + juce::String(input), "output=" + juce::String(output)));
+                suite.push_back(test);
+            }
+        }
+
+        // Long, dense feedback and narrowing
+
+        suite.push_back({ "feedback", juce::StringArray("stereowidth=0.4", "sendmid=0.8", "timemid=12000", "feedbackmid=0.85",
+                                                        "sendside=0.8", "timeside=300", "feedbackside=0.8",
+                                                        "cutoffmid=5000", "cutoffside=800") });
+
+        // Oversampled path
+
+        GoldenCase oversampled { "oversampling", echo };
+        oversampled.parameterValues.addArray(juce::StringArray("oversampling=1", "lfospeedmid=5", "lfodepthmid=200"));
+        suite.push_back(oversampled);
+
+        return suite;
+    }
+
+    bool runGoldenSuite(const Options& options)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+
+        options.goldenDirectory.createDirectory();
+
+        int numFailed = 0;
+
+        for (const auto& test : createGoldenSuite())
+        {
+            auto caseOptions = options;
+            caseOptions.presetName = {};
+            caseOptions.parameterValues = test.parameterValues;
+            caseOptions.seconds = 2.0;
+            caseOptions.outputDirectory = juce::File();
+            caseOptions.traceDirectory = juce::File();
+
+            Result result;
+            juce::AudioBuffer<float> output;
+
+            if (! runConfiguration(caseOptions, nullptr, sampleRate, blockSize, result, &output))
+                return false;
+
+            const auto goldenFile = options.goldenDirectory.getChildFile(test.name + ".wav");
+
+            if (options.record)
+            {
+                writeOutput(goldenFile, output, sampleRate, 32);
+                std::cout << "recorded  " << test.name << std::endl;
+                continue;
+            }
+
+            juce::AudioBuffer<float> golden;
+
+            if (! loadInput(goldenFile, golden) || golden.getNumSamples() != output.getNumSamples())
+            {
+                std::cout << "MISSING   " << test.name.paddedRight(' ', 14) << "record the goldens with --record" << std::endl;
+                ++numFailed;
+                continue;
+            }
+
+            float maxDifference = 0.f;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                    maxDifference = juce::jmax(maxDifference, std::abs(output.getSample(channel, i) - golden.getSample(channel, i)));
+
+            const bool passed = maxDifference <= options.tolerance;
+            numFailed += passed ? 0 : 1;
+
+            std::cout << (passed ? "ok        " : "FAILED    ") << test.name.paddedRight(' ', 14)
+                      << "max difference " << juce::String(juce::Decibels::gainToDecibels(maxDifference, -200.f), 1) << " dB" << std::endl;
+        }
+
+        return numFailed == 0;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;   // the processor's magic state needs a message manager
+
+    Options options;
+
+    if (! parseOptions(juce::ArgumentList(argc, argv), options))
+        return 1;
+
+    juce::AudioBuffer<float> fileInput;
+
+    if (options.inputFile != juce::File() && ! loadInput(options.inputFile, fileInput))
+    {
+        std::cerr << "Can't read input " << options.inputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (options.outputDirectory != juce::File())
+        options.outputDirectory.createDirectory();
+
+    if (options.traceDirectory != juce::File())
+    {
+       #if ECHO_CHAOS_PROFILING
+        options.traceDirectory.createDirectory();
+       #else
+        std::cerr << "--trace needs a build with ECHO_CHAOS_PROFILING=1 (the Profile configuration)" << std::endl;
+        return 1;
+       #endif
+    }
+
+    if (options.goldenDirectory != juce::File())
+        return runGoldenSuite(options) ? 0 : 1;
+
+    const auto baseline = options.baselineFile != juce::File() && ! options.record ? readBaseline(options.baselineFile)
+                                                                                   : std::map<juce::String, double>();
+    juce::StringArray recorded;
+    int numRegressed = 0;
+
+    std::cout << "    rate  block   ns/sample   realtime x    p50 us    p90 us    p99 us    max us" << std::endl;
+
+    for (auto sampleRate : options.sampleRates)
+    {
+        for (auto blockSize : options.blockSizes)
+        {
+            Result result;
+
+            if (! runConfiguration(options, fileInput.getNumSamples() > 0 ? &fileInput : nullptr, sampleRate, blockSize, result))
+                return 1;
+
+            std::cout << juce::String(juce::roundToInt(sampleRate)).paddedLeft(' ', 8)
+                      << juce::String(blockSize).paddedLeft(' ', 7)
+                      << juce::String(result.nsPerSample, 2).paddedLeft(' ', 12)
+                      << juce::String(result.realtimeFactor, 1).paddedLeft(' ', 13)
+                      << juce::String(result.p50, 2).paddedLeft(' ', 10)
+                      << juce::String(result.p90, 2).paddedLeft(' ', 10)
+                      << juce::String(result.p99, 2).paddedLeft(' ', 10)
+                      << juce::String(result.maxBlock, 2).paddedLeft(' ', 10);
+
+            // Against the baseline, when there is one for this configuration
+
+            const auto name = configurationName(sampleRate, blockSize);
+            recorded.add(name + " " + juce::String(result.nsPerSample, 3));
+
+            if (const auto entry = baseline.find(name); entry != baseline.end() && entry->second > 0.0)
+            {
+                const double change = 100.0 * (result.nsPerSample / entry->second - 1.0);
+                const bool regressed = change > options.threshold;
+                numRegressed += regressed ? 1 : 0;
+
+                std::cout << juce::String(change, 1).paddedLeft(' ', 9) << " %" << (regressed ? "  REGRESSED" : "");
+            }
+
+            std::cout << std::endl;
+        }
+    }
+
+    if (options.record && options.baselineFile != juce::File())
+        options.baselineFile.replaceWithText(recorded.joinIntoString("\n") + "\n");
+
+    return numRegressed == 0 ? 0 : 1;
+}
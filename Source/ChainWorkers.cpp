@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    ChainWorkers.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "ChainWorkers.h"
+
+ChainWorkers::~ChainWorkers()
+{
+    numWorkers = 0;
+
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto* worker : workers)
+        worker->stopThread(1000);
+}
+
+void ChainWorkers::start()
+{
+    const juce::ScopedLock sl(lock);
+
+    if (! workers.isEmpty())
+        return;
+
+    const int count = juce::jmax(0, juce::SystemStats::getNumCpus() - 1);
+
+    pending.ensureStorageAllocated(maxPendingBatches);
+    workers.ensureStorageAllocated(count);     // run() reads the array while others may start
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+        worker->startThread();
+    }
+
+    numWorkers = count;
+}
+
+//==============================================================================
+
+void ChainWorkers::run(Job& job, int numTasks) noexcept
+{
+    const int count = numWorkers.load();
+
+    if (count == 0 || numTasks < 2)
+    {
+        for (int task = 0; task < numTasks; ++task)
+            job.runTask(task);
+
+        return;
+    }
+
+    Batch batch;
+    batch.job = &job;
+    batch.numTasks = numTasks;
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (pending.size() >= maxPendingBatches)
+            batch.numTasks = 0;                 // too many instances at once: this one runs alone
+        else
+            pending.add(&batch);
+    }
+
+    if (batch.numTasks == 0)
+    {
+        for (int task = 0; task < numTasks; ++task)
+            job.runTask(task);
+
+        return;
+    }
+
+    for (int i = 0; i < juce::jmin(count, numTasks - 1); ++i)
+        workers.getUnchecked(i)->notify();
+
+    work(batch);
+
+    // No worker can join once the batch is off the list; wait for those inside
+
+    {
+        const juce::ScopedLock sl(lock);
+        pending.removeFirstMatchingValue(&batch);
+    }
+
+    for (;;)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (batch.users == 0)
+                break;
+        }
+
+        batch.finished.wait(-1);
+    }
+}
+
+void ChainWorkers::work(Batch& batch) noexcept
+{
+    for (int task = batch.nextTask++; task < batch.numTasks; task = batch.nextTask++)
+        batch.job->runTask(task);
+}
+
+ChainWorkers::Batch* ChainWorkers::joinPendingBatch() noexcept
+{
+    const juce::ScopedLock sl(lock);
+
+    for (auto* batch : pending)
+    {
+        if (batch->nextTask.load() < batch->numTasks)
+        {
+            ++batch->users;
+            return batch;
+        }
+    }
+
+    return nullptr;
+}
+
+//==============================================================================
+
+ChainWorkers::Worker::Worker(ChainWorkers& o, int index)
+    : juce::Thread("Echo Chaos worker " + juce::String(index + 1)), owner(o)
+{
+}
+
+void ChainWorkers::Worker::run()
+{
+    // The audio thread flushes denormals for its own tasks; do the same for the ones run here
+
+    juce::ScopedNoDenormals noDenormals;
+
+    while (! threadShouldExit())
+    {
+        auto* batch = owner.joinPendingBatch();
+
+        if (batch == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+
+        work(*batch);
+
+        // Signalled under the lock, so the batch is still alive
+        const juce::ScopedLock sl(owner.lock);
+
+        if (--batch->users == 0)
+            batch->finished.signal();
+    }
+}
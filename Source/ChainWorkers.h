@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    ChainWorkers.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    ChainWorkers is the pool of threads offline renders spread their lanes over.
+    Once encoded, the lanes share no state until the partner taps are mixed back,
+    so an offline processBlock hands them out as tasks and joins before going on.
+
+    One pool is shared by every instance (through juce::SharedResourcePointer),
+    with one thread less than there are cores: the calling thread works on its
+    own batch too. Several instances bouncing at once queue their batches side by
+    side and the workers pick tasks from whichever still has some, so a render of
+    many stems keeps every core busy without one pool per instance.
+
+    The threads only start on the first start() call, from prepareToPlay of an
+    offline render; realtime instances never create them. run() doesn't allocate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ChainWorkers
+{
+public:
+
+    struct Job
+    {
+        virtual ~Job() = default;
+        virtual void runTask(int index) noexcept = 0;
+    };
+
+    ChainWorkers() = default;
+    ~ChainWorkers();
+
+    // Starts the threads if they aren't running yet; message thread
+    void start();
+
+    int getNumWorkers() const noexcept { return numWorkers.load(); }
+
+    // Calls job.runTask(0 .. numTasks - 1) from the workers and the calling thread,
+    // returning once every task is done. Without workers it simply runs them in order.
+    void run(Job& job, int numTasks) noexcept;
+
+private:
+
+    struct Batch
+    {
+        Job* job = nullptr;
+        int numTasks = 0;
+        std::atomic<int> nextTask { 0 };
+        int users = 0;                          // workers inside the batch, guarded by lock
+        juce::WaitableEvent finished;
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(ChainWorkers& owner, int index);
+        void run() override;
+
+    private:
+        ChainWorkers& owner;
+    };
+
+    static void work(Batch& batch) noexcept;
+    Batch* joinPendingBatch() noexcept;
+
+    static constexpr int maxPendingBatches = 64;
+
+    juce::CriticalSection lock;
+    juce::Array<Batch*> pending;                // batches with tasks left, at most maxPendingBatches
+    juce::OwnedArray<Worker> workers;
+    std::atomic<int> numWorkers { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChainWorkers)
+};
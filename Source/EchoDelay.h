@@ -0,0 +1,400 @@
+/*
+  ==============================================================================
+
+    EchoDelay.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    EchoDelay is a single-channel feedback delay line, templated on its storage
+    type (float by default, double for the double precision engine) and on its
+    interpolation:
+
+        None          integer read, delay rounded down
+        Linear        2 taps
+        Lagrange3rd   4 taps, 3rd order Lagrange polynomial
+        Thiran        1st order allpass (keep the delay time static or slow)
+        WindowedSinc  8 taps, Hann-windowed sinc from a shared table
+
+    Delays are measured from the last written sample: read(1) returns the most
+    recent write. Each interpolation has its own minimum delay, reads below it
+    are clamped.
+
+    process() is the block kernel. When the delay time isn't modulated it falls
+    back to the cheapest exact read: an integer delay reads straight from the
+    buffer (as one block copy when the delay is at least a block long), and a
+    fractional one computes the interpolation weights once per block.
+
+    processTaps() reads several taps from the same buffer, tap 0 being the one
+    that feeds back. With Lagrange interpolation the taps sit in the lanes of a
+    SIMD register, so their weights and sums are computed together.
+
+    The block kernels take delay times and feedback as float whatever the storage
+    type: they are control signals, rendered once in float for either engine.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace EchoDelayInterpolation
+{
+    struct None           { static constexpr int minimumDelay = 1; };
+    struct Linear         { static constexpr int minimumDelay = 1; };
+    struct Lagrange3rd    { static constexpr int minimumDelay = 2; };
+    struct Thiran         { static constexpr int minimumDelay = 1; };
+    struct WindowedSinc   { static constexpr int minimumDelay = 4; };
+
+    // Weights of the 8 sinc taps (delays d-3 .. d+4) for a fractional delay,
+    // quantised to 1/numPhases of a sample. Built once, shared by every delay line.
+    struct SincTable
+    {
+        static constexpr int numTaps = 8;
+        static constexpr int numPhases = 1024;
+
+        SincTable()
+        {
+            for (int phase = 0; phase <= numPhases; ++phase)
+            {
+                const double frac = (double) phase / numPhases;
+                double sum = 0;
+
+                for (int tap = 0; tap < numTaps; ++tap)
+                {
+                    const double x = (tap - 3) - frac;      // distance from the read position
+                    const double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                    const double window = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * x / 4.0));
+
+                    weights[phase][tap] = (float) (sinc * window);
+                    sum += sinc * window;
+                }
+
+                for (int tap = 0; tap < numTaps; ++tap)
+                    weights[phase][tap] = (float) (weights[phase][tap] / sum);
+            }
+        }
+
+        static const SincTable& get()
+        {
+            static const SincTable table;
+            return table;
+        }
+
+        float weights[numPhases + 1][numTaps];
+    };
+}
+
+template <typename SampleType = float, typename Interpolation = EchoDelayInterpolation::Lagrange3rd>
+class EchoDelay
+{
+public:
+
+    static constexpr int minimumDelay = Interpolation::minimumDelay;
+
+    // Allocates when the size changes; call from prepareToPlay
+    void prepare(int maximumDelayInSamples)
+    {
+        // room for the taps past the maximum delay, rounded up to a power of two for cheap wrapping
+        const int size = juce::nextPowerOfTwo(juce::jmax(maximumDelayInSamples, minimumDelay) + 8);
+
+        if (buffer.size() != (size_t) size)
+            std::vector<SampleType>((size_t) size).swap(buffer);    // exact capacity, also when shrinking
+
+        mask = size - 1;
+        maximumDelay = size - 8;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill(buffer.begin(), buffer.end(), SampleType(0));
+        writePos = 0;
+        thiranState = 0;
+    }
+
+    int getMaximumDelayInSamples() const noexcept { return maximumDelay; }
+
+    //==============================================================================
+    // Per sample
+
+    SampleType readInteger(int delay) const noexcept
+    {
+        return buffer[(size_t) ((writePos - delay) & mask)];
+    }
+
+    SampleType read(SampleType delay) noexcept
+    {
+        delay = clampDelay(delay);
+
+        const int delayInt = (int) delay;
+        const SampleType frac = delay - (SampleType) delayInt;
+
+        return readFractional(delayInt, frac);
+    }
+
+    void write(SampleType sample) noexcept
+    {
+        buffer[(size_t) writePos] = sample;
+        writePos = (writePos + 1) & mask;
+    }
+
+    //==============================================================================
+    // Block kernel. For every sample:
+    //     wet[i] = read(delay)         delay = delays[i], or staticDelay if delays is null
+    //     write(input[i] + wet[i] * feedback)
+    // wetOutput must not alias input.
+
+    void process(const SampleType* input, SampleType* wetOutput, const float* delays,
+                 float staticDelay, float feedback, int numSamples) noexcept
+    {
+        if (delays != nullptr)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const SampleType in = input[i];
+                const SampleType wet = read(delays[i]);
+                write(in + wet * feedback);
+                wetOutput[i] = wet;
+            }
+
+            return;
+        }
+
+        const SampleType delay = clampDelay((SampleType) staticDelay);
+
+        const int delayInt = (int) delay;
+        const SampleType frac = delay - (SampleType) delayInt;
+
+        if (frac == SampleType(0) || std::is_same<Interpolation, EchoDelayInterpolation::None>::value)
+            processInteger(input, wetOutput, delayInt, (SampleType) feedback, numSamples);
+        else
+            processStaticFractional(input, wetOutput, delayInt, frac, (SampleType) feedback, numSamples);
+    }
+
+    // As above, with the feedback ramped per sample
+    void process(const SampleType* input, SampleType* wetOutput, const float* delays,
+                 float staticDelay, const float* feedbacks, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType in = input[i];
+            const SampleType wet = read((SampleType) (delays != nullptr ? delays[i] : staticDelay));
+            write(in + wet * (SampleType) feedbacks[i]);
+            wetOutput[i] = wet;
+        }
+    }
+
+    // Multi-tap block kernel, for numTaps taps. For every sample:
+    //     tapOutputs[k][i] = read(delays[k][i]), or read(delays[k][0]) when delaysAreStatic
+    //     write(input[i] + tapOutputs[0][i] * feedback)    feedback = feedbacks[i], or staticFeedback if feedbacks is null
+    // The outputs must not alias input.
+
+    void processTaps(const SampleType* input, SampleType* const* tapOutputs, const float* const* delays, bool delaysAreStatic,
+                     int numTaps, const float* feedbacks, float staticFeedback, int numSamples) noexcept
+    {
+        using Vec = juce::dsp::SIMDRegister<SampleType>;
+        constexpr int width = (int) Vec::SIMDNumElements;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int index = delaysAreStatic ? 0 : i;
+
+            if constexpr (std::is_same<Interpolation, EchoDelayInterpolation::Lagrange3rd>::value)
+            {
+                for (int first = 0; first < numTaps; first += width)
+                {
+                    // Gather the four neighbours of every tap, then weigh them all at once
+
+                    Vec frac = Vec::expand(0), x0 = frac, x1 = frac, x2 = frac, x3 = frac;
+                    const int count = juce::jmin(width, numTaps - first);
+
+                    for (int k = 0; k < count; ++k)
+                    {
+                        const SampleType delay = clampDelay((SampleType) delays[first + k][index]);
+                        const int delayInt = (int) delay;
+
+                        frac.set((size_t) k, delay - (SampleType) delayInt);
+                        x0.set((size_t) k, at(delayInt - 1));
+                        x1.set((size_t) k, at(delayInt));
+                        x2.set((size_t) k, at(delayInt + 1));
+                        x3.set((size_t) k, at(delayInt + 2));
+                    }
+
+                    // lagrangeWeights() for every lane: t = frac + 1, so t - 1 = frac
+
+                    const Vec t = frac + Vec::expand(1), t2 = frac - Vec::expand(1), t3 = frac - Vec::expand(2);
+
+                    const Vec wet = frac * t2 * t3 * x0 * Vec::expand(SampleType(-1) / 6)
+                                  + t * t2 * t3 * x1 * Vec::expand(SampleType(1) / 2)
+                                  + t * frac * t3 * x2 * Vec::expand(SampleType(-1) / 2)
+                                  + t * frac * t2 * x3 * Vec::expand(SampleType(1) / 6);
+
+                    for (int k = 0; k < count; ++k)
+                        tapOutputs[first + k][i] = wet.get((size_t) k);
+                }
+            }
+            else
+            {
+                for (int k = 0; k < numTaps; ++k)
+                    tapOutputs[k][i] = read((SampleType) delays[k][index]);
+            }
+
+            write(input[i] + tapOutputs[0][i] * (SampleType) (feedbacks != nullptr ? feedbacks[i] : staticFeedback));
+        }
+    }
+
+private:
+
+    SampleType clampDelay(SampleType delay) const noexcept
+    {
+        return juce::jlimit((SampleType) minimumDelay, (SampleType) maximumDelay, delay);
+    }
+
+    SampleType at(int delay) const noexcept
+    {
+        return buffer[(size_t) ((writePos - delay) & mask)];
+    }
+
+    SampleType readFractional(int delayInt, SampleType frac) noexcept
+    {
+        using namespace EchoDelayInterpolation;
+
+        if constexpr (std::is_same<Interpolation, None>::value)
+        {
+            juce::ignoreUnused(frac);
+            return at(delayInt);
+        }
+        else if constexpr (std::is_same<Interpolation, Linear>::value)
+        {
+            return at(delayInt) + frac * (at(delayInt + 1) - at(delayInt));
+        }
+        else if constexpr (std::is_same<Interpolation, Lagrange3rd>::value)
+        {
+            SampleType w[4];
+            lagrangeWeights(frac, w);
+            return w[0] * at(delayInt - 1) + w[1] * at(delayInt) + w[2] * at(delayInt + 1) + w[3] * at(delayInt + 2);
+        }
+        else if constexpr (std::is_same<Interpolation, Thiran>::value)
+        {
+            if (frac == SampleType(0))
+            {
+                thiranState = at(delayInt);
+                return thiranState;
+            }
+
+            // Keep the fraction in [0.618, 1.618) where the allpass behaves best
+            if (frac < SampleType(0.618) && delayInt > minimumDelay)
+            {
+                frac += 1;
+                --delayInt;
+            }
+
+            const SampleType alpha = (1 - frac) / (1 + frac);
+            thiranState = at(delayInt + 1) + alpha * (at(delayInt) - thiranState);
+            return thiranState;
+        }
+        else
+        {
+            const auto& w = sincWeights(frac);
+            SampleType sum = 0;
+
+            for (int tap = 0; tap < SincTable::numTaps; ++tap)
+                sum += (SampleType) w[tap] * at(delayInt - 3 + tap);
+
+            return sum;
+        }
+    }
+
+    // Lagrange weights for the taps at delays d-1, d, d+1, d+2 when reading at d + frac
+    static void lagrangeWeights(SampleType frac, SampleType* w) noexcept
+    {
+        const SampleType t = frac + 1;   // position relative to the d-1 tap
+        const SampleType t1 = t - 1, t2 = t - 2, t3 = t - 3;
+
+        w[0] = -t1 * t2 * t3 / 6;
+        w[1] =  t  * t2 * t3 / 2;
+        w[2] = -t  * t1 * t3 / 2;
+        w[3] =  t  * t1 * t2 / 6;
+    }
+
+    using SincTable = EchoDelayInterpolation::SincTable;
+
+    static const float (&sincWeights(SampleType frac) noexcept)[SincTable::numTaps]
+    {
+        return SincTable::get().weights[(int) (frac * SincTable::numPhases + SampleType(0.5))];
+    }
+
+    void processInteger(const SampleType* input, SampleType* wetOutput, int delay, SampleType feedback, int numSamples) noexcept
+    {
+        if (delay < numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const SampleType in = input[i];
+                const SampleType wet = at(delay);
+                write(in + wet * feedback);
+                wetOutput[i] = wet;
+            }
+        }
+        else
+        {
+            // The whole block reads samples written before it: copy it out, then write it back in
+
+            copyFromRing(wetOutput, (writePos - delay) & mask, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                buffer[(size_t) writePos] = input[i] + wetOutput[i] * feedback;
+                writePos = (writePos + 1) & mask;
+            }
+        }
+
+        if (numSamples > 0)
+            thiranState = wetOutput[numSamples - 1];   // keeps the allpass in step for the next modulated read
+    }
+
+    void processStaticFractional(const SampleType* input, SampleType* wetOutput, int delayInt, SampleType frac,
+                                 SampleType feedback, int numSamples) noexcept
+    {
+        using namespace EchoDelayInterpolation;
+
+        if constexpr (std::is_same<Interpolation, Lagrange3rd>::value)
+        {
+            SampleType w[4];
+            lagrangeWeights(frac, w);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const SampleType in = input[i];
+                const SampleType wet = w[0] * at(delayInt - 1) + w[1] * at(delayInt) + w[2] * at(delayInt + 1) + w[3] * at(delayInt + 2);
+                write(in + wet * feedback);
+                wetOutput[i] = wet;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const SampleType in = input[i];
+                const SampleType wet = readFractional(delayInt, frac);
+                write(in + wet * feedback);
+                wetOutput[i] = wet;
+            }
+        }
+    }
+
+    void copyFromRing(SampleType* dest, int start, int numSamples) const noexcept
+    {
+        const int first = juce::jmin(numSamples, mask + 1 - start);
+
+        std::copy(buffer.begin() + start, buffer.begin() + start + first, dest);
+        std::copy(buffer.begin(), buffer.begin() + (numSamples - first), dest + first);
+    }
+
+    std::vector<SampleType> buffer;
+    int mask = 0;
+    int writePos = 0;
+    int maximumDelay = 0;
+    SampleType thiranState = 0;
+};
@@ -5,6 +5,11 @@
     Created: 15 Aug 2023 6:22:24pm
     Author:  Pablo Tablas
 
+    The parameter registry. Every parameter is described once in the constexpr
+    table below; the table generates the layout groups, gives each parameter a
+    dense index (Ek0Ka0s::Param) and backs the lock-free per-block Snapshot the
+    audio thread reads instead of listening to string-keyed callbacks.
+
   ==============================================================================
 */
 
@@ -16,9 +21,165 @@ class Ek0Ka0s
 {
 public:
 
+    // Dense parameter indices, in the same order as the descriptor table
+
+    enum Param
+    {
+        stereowidth = 0,
+        input,
+        output,
+        oversampling,
+        offlineoversampling,
+
+        cutoffmid,
+        resonancemid,
+        modemid,
+        sendmid,
+        timemid,
+        feedbackmid,
+        lfospeedmid,
+        lfodepthmid,
+        waveformmid,
+        lfocutoffmid,
+        tapsmid,
+        tapspreadmid,
+        tapgainmid,
+        tapwidthmid,
+        lforangemid,
+
+        cutoffside,
+        resonanceside,
+        modeside,
+        sendside,
+        timeside,
+        feedbackside,
+        lfospeedside,
+        lfodepthside,
+        waveformside,
+        lfocutoffside,
+        tapsside,
+        tapspreadside,
+        tapgainside,
+        tapwidthside,
+        lforangeside,
+
+        numParams
+    };
+
+    enum class Group { ms, mid, side };
+
+    struct ParamDescriptor
+    {
+        Param index;
+        const char* id;
+        const char* name;
+        Group group;
+
+        float minValue, maxValue, interval, skew, defaultValue;
+
+        const char* const* choices;  // non-null -> AudioParameterChoice, defaultValue is the index
+        int numChoices;
+    };
+
+    static constexpr const char* ioChoices[] = { "Stereo", "Mid/Side" };
+    static constexpr const char* filterChoices[] = { "LPF", "BPF", "HPF" };
+    static constexpr const char* oversamplingChoices[] = { "Off", "2x", "4x", "8x" };
+    static constexpr const char* waveformChoices[] = { "Sine", "Triangle", "Sawtooth", "Square", "Random", "Sample & Hold" };
+    static constexpr const char* lfoRangeChoices[] = { "LFO", "CHAOS" };
+
+    // CHAOS scales the LFO speed dial into the audio range (up to 1 kHz)
+    static constexpr float chaosSpeedScale = 100.f;
+
+    static constexpr ParamDescriptor descriptors[numParams] =
+    {
+        { stereowidth,   "stereowidth",   "StereoWidth",      Group::ms,   0.f,   2.f,          0.f,     1.f,  1.f, nullptr, 0 },
+        { input,         "input",         "Input",            Group::ms,   0.f,   1.f,          1.f,     1.f,  0.f, ioChoices, 2 },
+        { output,        "output",        "Output",           Group::ms,   0.f,   1.f,          1.f,     1.f,  0.f, ioChoices, 2 },
+        //Oversampling of the filter/delay path                                                               (offline is never below realtime)
+        { oversampling,        "oversampling",        "Oversampling",         Group::ms, 0.f, 3.f, 1.f, 1.f, 0.f, oversamplingChoices, 4 },
+        { offlineoversampling, "offlineoversampling", "Offline Oversampling", Group::ms, 0.f, 3.f, 1.f, 1.f, 0.f, oversamplingChoices, 4 },
+
+        //Filter                                                                                               (skew -> more of the dial affects lower side)
+        { cutoffmid,     "cutoffmid",     "cutoffMid",        Group::mid,  20.f,  20000.f,      0.0001f, 0.6f, 200.f, nullptr, 0 },
+        { resonancemid,  "resonancemid",  "ResonanceMid",     Group::mid,  0.1f,  0.7f,         0.f,     1.f,  0.1f, nullptr, 0 },
+        { modemid,       "modemid",       "Filter Type Mid",  Group::mid,  0.f,   2.f,          1.f,     1.f,  0.f, filterChoices, 3 },
+        //Delay                                                                                                (send is dry/wet, time in samples)
+        { sendmid,       "sendmid",       "SendMid",          Group::mid,  0.f,   1.f,          0.f,     1.f,  0.f, nullptr, 0 },
+        { timemid,       "timemid",       "TimeMid",          Group::mid,  0.f,   20000.f,      0.f,     1.f,  0.f, nullptr, 0 },
+        { feedbackmid,   "feedbackmid",   "FeedbackMid",      Group::mid,  0.f,   0.9f,         0.f,     1.f,  0.0001f, nullptr, 0 },
+        //LFO                                                                                                  (speed in Hertz, depth in samples since it modulates time, cutoff in octaves)
+        { lfospeedmid,   "lfospeedmid",   "LFOSpeedMid",      Group::mid,  0.f,   10.f,         0.0001f, 0.6f, 0.f, nullptr, 0 },
+        { lfodepthmid,   "lfodepthmid",   "LFODepthMid",      Group::mid,  0.f,   20000.f / 2.f, 0.0001f, 0.6f, 0.f, nullptr, 0 },
+        { waveformmid,   "waveformmid",   "WaveformMid",      Group::mid,  0.f,   5.f,          1.f,     1.f,  0.f, waveformChoices, 6 },
+        { lfocutoffmid,  "lfocutoffmid",  "LFOCutoffMid",     Group::mid,  0.f,   4.f,          0.f,     1.f,  0.f, nullptr, 0 },
+        //Taps                                                                                                 (extra taps share the delay line: spread places them below the time, width pans them)
+        { tapsmid,       "tapsmid",       "TapsMid",          Group::mid,  1.f,   4.f,          1.f,     1.f,  1.f, nullptr, 0 },
+        { tapspreadmid,  "tapspreadmid",  "TapSpreadMid",     Group::mid,  0.f,   1.f,          0.f,     1.f,  0.5f, nullptr, 0 },
+        { tapgainmid,    "tapgainmid",    "TapGainMid",       Group::mid,  0.f,   1.f,          0.f,     1.f,  0.7f, nullptr, 0 },
+        { tapwidthmid,   "tapwidthmid",   "TapWidthMid",      Group::mid,  0.f,   1.f,          0.f,     1.f,  0.5f, nullptr, 0 },
+        //LFO range                                                                                            (CHAOS runs the LFO at audio rate, for FM-like delay modulation)
+        { lforangemid,   "lforangemid",   "LFORangeMid",      Group::mid,  0.f,   1.f,          1.f,     1.f,  0.f, lfoRangeChoices, 2 },
+
+        { cutoffside,    "cutoffside",    "cutoffSide",       Group::side, 20.f,  20000.f,      0.0001f, 0.6f, 200.f, nullptr, 0 },
+        { resonanceside, "resonanceside", "ResonanceSide",    Group::side, 0.1f,  0.7f,         0.f,     1.f,  0.1f, nullptr, 0 },
+        { modeside,      "modeside",      "Filter Type Side", Group::side, 0.f,   2.f,          1.f,     1.f,  0.f, filterChoices, 3 },
+        { sendside,      "sendside",      "SendSide",         Group::side, 0.f,   1.f,          0.f,     1.f,  0.f, nullptr, 0 },
+        { timeside,      "timeside",      "TimeSide",         Group::side, 0.f,   20000.f,      0.f,     1.f,  0.f, nullptr, 0 },
+        { feedbackside,  "feedbackside",  "FeedbackSide",     Group::side, 0.f,   0.9f,         0.f,     1.f,  0.0001f, nullptr, 0 },
+        { lfospeedside,  "lfospeedside",  "LFOSpeedSide",     Group::side, 0.f,   10.f,         0.0001f, 0.6f, 0.f, nullptr, 0 },
+        { lfodepthside,  "lfodepthside",  "LFODepthSide",     Group::side, 0.f,   20000.f / 2.f, 0.0001f, 0.6f, 0.f, nullptr, 0 },
+        { waveformside,  "waveformside",  "WaveformSide",     Group::side, 0.f,   5.f,          1.f,     1.f,  0.f, waveformChoices, 6 },
+        { lfocutoffside, "lfocutoffside", "LFOCutoffSide",    Group::side, 0.f,   4.f,          0.f,     1.f,  0.f, nullptr, 0 },
+        { tapsside,      "tapsside",      "TapsSide",         Group::side, 1.f,   4.f,          1.f,     1.f,  1.f, nullptr, 0 },
+        { tapspreadside, "tapspreadside", "TapSpreadSide",    Group::side, 0.f,   1.f,          0.f,     1.f,  0.5f, nullptr, 0 },
+        { tapgainside,   "tapgainside",   "TapGainSide",      Group::side, 0.f,   1.f,          0.f,     1.f,  0.7f, nullptr, 0 },
+        { tapwidthside,  "tapwidthside",  "TapWidthSide",     Group::side, 0.f,   1.f,          0.f,     1.f,  0.5f, nullptr, 0 },
+        { lforangeside,  "lforangeside",  "LFORangeSide",     Group::side, 0.f,   1.f,          1.f,     1.f,  0.f, lfoRangeChoices, 2 },
+    };
+
+    //==============================================================================
+    // Parameter values as the audio thread sees them for one block
+
+    struct Snapshot
+    {
+        std::array<float, numParams> values{};
+
+        float operator[](Param p) const noexcept { return values[(size_t) p]; }
+        int choice(Param p) const noexcept       { return juce::roundToInt(values[(size_t) p]); }
+    };
+
+    // Caches the raw std::atomic<float>* of every parameter once, so loading a
+    // Snapshot is numParams relaxed loads with no string lookups.
+
+    class ParameterCache
+    {
+    public:
+        void attach(juce::AudioProcessorValueTreeState& state);
+        Snapshot load() const noexcept;
+
+    private:
+        std::array<std::atomic<float>*, numParams> raw{};
+    };
+
+    //==============================================================================
+
     static void addMSParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
     static void addMidParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
     static void addSideParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout);
 
     Ek0Ka0s() = default;
-};
\ No newline at end of file
+};
+
+namespace Ek0Ka0sRegistryChecks
+{
+    constexpr bool descriptorsAreDense()
+    {
+        for (int i = 0; i < Ek0Ka0s::numParams; ++i)
+            if (Ek0Ka0s::descriptors[i].index != i)
+                return false;
+
+        return true;
+    }
+
+    static_assert(descriptorsAreDense(), "Ek0Ka0s::descriptors must be listed in Param order");
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    FastRandom.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    FastRandom is a small-state PCG32 generator (O'Neill, pcg-random.org). It
+    never touches the OS, holds 16 bytes per instance and is fully determined by
+    its seed and stream, so a seeded Random LFO renders the same way every time.
+
+    Like Osc, it doesn't depend on JUCE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+class FastRandom
+{
+public:
+
+    FastRandom() { setSeed(0x853c49e6748fea9bULL); }
+
+    explicit FastRandom(uint64_t seed, uint64_t stream = 0) { setSeed(seed, stream); }
+
+    // Instances seeded alike but on different streams produce unrelated sequences
+    void setSeed(uint64_t seed, uint64_t stream = 0) noexcept
+    {
+        m_state = 0;
+        m_increment = (stream << 1u) | 1u;
+        nextUInt32();
+        m_state += seed;
+        nextUInt32();
+    }
+
+    uint32_t nextUInt32() noexcept
+    {
+        const uint64_t oldState = m_state;
+        m_state = oldState * 6364136223846793005ULL + m_increment;
+
+        const uint32_t xorShifted = (uint32_t) (((oldState >> 18u) ^ oldState) >> 27u);
+        const uint32_t rotation = (uint32_t) (oldState >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+    }
+
+    // Uniform in [-1, 1)
+    float nextBipolar() noexcept
+    {
+        return (float) (int32_t) nextUInt32() * (1.f / 2147483648.f);
+    }
+
+    // Block-sized batch of nextBipolar() values
+    void fillBipolar(float* dest, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = nextBipolar();
+    }
+
+private:
+
+    uint64_t m_state = 0;
+    uint64_t m_increment = 1;
+};
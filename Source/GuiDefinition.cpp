@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+
+    GuiDefinition.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "GuiDefinition.h"
+
+GuiDefinition::GuiDefinition()
+    : tree(juce::ValueTree::fromXml(juce::String::createStringFromData(BinaryData::magic_xml, BinaryData::magic_xmlSize)))
+{
+    jassert(tree.isValid());    // an invalid tree falls back to foleys' generated editor
+}
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    GuiDefinition.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    GuiDefinition is the editor layout, parsed from the magic.xml embedded in
+    BinaryData when the first instance is created and shared by every other one
+    through juce::SharedResourcePointer, so loading a project with many
+    instances neither touches the filesystem nor parses the XML again. Each
+    editor gets its own copy of the tree, so editing one layout never reaches
+    the others.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class GuiDefinition
+{
+public:
+
+    GuiDefinition();
+
+    // Message thread, when an editor is created
+    juce::ValueTree createCopy() const { return tree.createCopy(); }
+
+private:
+
+    juce::ValueTree tree;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GuiDefinition)
+};
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    LoadMeter.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "LoadMeter.h"
+
+namespace
+{
+    const char* const signalNames[] = { "input", "mid", "side", "output" };
+}
+
+LoadMeter::~LoadMeter()
+{
+    stopTimer();
+}
+
+void LoadMeter::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    load = 0.f;
+    peakLoad = 0.f;
+
+    for (int signal = 0; signal < numSignals; ++signal)
+    {
+        peak[(size_t) signal] = 0.f;
+        rms[(size_t) signal] = 0.f;
+    }
+
+    meanSquare.fill(0.0);
+}
+
+void LoadMeter::setProperties(foleys::MagicProcessorState& state)
+{
+    const auto path = juce::String(propertyNode) + "/";
+
+    loadProperty.referTo(state.getPropertyAsValue(path + "load"));
+    peakLoadProperty.referTo(state.getPropertyAsValue(path + "load-peak"));
+
+    for (int signal = 0; signal < numSignals; ++signal)
+    {
+        peakProperties[(size_t) signal].referTo(state.getPropertyAsValue(path + signalNames[signal] + "-peak"));
+        rmsProperties[(size_t) signal].referTo(state.getPropertyAsValue(path + signalNames[signal] + "-rms"));
+    }
+}
+
+void LoadMeter::setEditorOpen(bool isOpen)
+{
+    editorOpen.store(isOpen, std::memory_order_relaxed);
+
+    if (isOpen)
+        startTimerHz(publishHz);
+    else
+        stopTimer();
+}
+
+//==============================================================================
+
+void LoadMeter::beginBlock() noexcept
+{
+    blockStart = juce::Time::getHighResolutionTicks();
+
+    blockPeak.fill(0.f);
+    blockSumOfSquares.fill(0.0);
+    blockCount.fill(0);
+}
+
+void LoadMeter::measure(Signal signal, const float* samples, int numSamples) noexcept
+{
+    addLevel(signal, samples, numSamples);
+}
+
+void LoadMeter::measure(Signal signal, const double* samples, int numSamples) noexcept
+{
+    addLevel(signal, samples, numSamples);
+}
+
+template <typename SampleType>
+void LoadMeter::addLevel(Signal signal, const SampleType* samples, int numSamples) noexcept
+{
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+
+    // Scalar up to the first aligned sample, whole registers, then the scalar rest
+
+    const auto* aligned = Vec::getNextSIMDAlignedPtr(const_cast<SampleType*>(samples));
+    const int head = juce::jmin(numSamples, (int) (aligned - samples));
+    const int numVectors = (numSamples - head) / (int) Vec::SIMDNumElements;
+    const int tail = head + numVectors * (int) Vec::SIMDNumElements;
+
+    SampleType maxValue = 0, sumOfSquares = 0;
+
+    for (int i = 0; i < head; ++i)
+    {
+        maxValue = juce::jmax(maxValue, std::abs(samples[i]));
+        sumOfSquares += samples[i] * samples[i];
+    }
+
+    auto maxVec = Vec::expand(SampleType(0)), sumVec = Vec::expand(SampleType(0));
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        const auto x = Vec::fromRawArray(aligned + v * (int) Vec::SIMDNumElements);
+        maxVec = Vec::max(maxVec, Vec::abs(x));
+        sumVec += x * x;
+    }
+
+    for (size_t i = 0; i < Vec::SIMDNumElements; ++i)
+        maxValue = juce::jmax(maxValue, maxVec.get(i));
+
+    sumOfSquares += sumVec.sum();
+
+    for (int i = tail; i < numSamples; ++i)
+    {
+        maxValue = juce::jmax(maxValue, std::abs(samples[i]));
+        sumOfSquares += samples[i] * samples[i];
+    }
+
+    blockPeak[(size_t) signal] = juce::jmax(blockPeak[(size_t) signal], (float) maxValue);
+    blockSumOfSquares[(size_t) signal] += sumOfSquares;
+    blockCount[(size_t) signal] += numSamples;
+}
+
+void LoadMeter::endBlock(int numSamples) noexcept
+{
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - blockStart);
+    const double budget = numSamples / sampleRate;
+
+    if (budget > 0.0)
+    {
+        const auto blockLoad = (float) (elapsed / budget);
+        load.store(blockLoad, std::memory_order_relaxed);
+        storeMax(peakLoad, blockLoad);
+    }
+
+    for (int signal = 0; signal < numSignals; ++signal)
+    {
+        const auto i = (size_t) signal;
+
+        if (blockCount[i] == 0)
+            continue;
+
+        // One-pole average, its coefficient scaled by the block length
+
+        const double coefficient = 1.0 - std::exp(-blockCount[i] / (rmsSeconds * sampleRate));
+        meanSquare[i] += (blockSumOfSquares[i] / blockCount[i] - meanSquare[i]) * coefficient;
+
+        storeMax(peak[i], blockPeak[i]);
+        rms[i].store((float) std::sqrt(meanSquare[i]), std::memory_order_relaxed);
+    }
+}
+
+void LoadMeter::storeMax(std::atomic<float>& value, float newValue) noexcept
+{
+    // Raises the held value; the timer resets it when it reads it
+
+    auto current = value.load(std::memory_order_relaxed);
+
+    while (newValue > current && ! value.compare_exchange_weak(current, newValue, std::memory_order_relaxed))
+        ;
+}
+
+//==============================================================================
+
+void LoadMeter::timerCallback()
+{
+    // Load in percent of the block's budget, levels in dB, to one decimal for the labels
+
+    auto display = [](double value) { return std::round(value * 10.0) / 10.0; };
+
+    loadProperty = display(100.0 * load.load(std::memory_order_relaxed));
+    peakLoadProperty = display(100.0 * peakLoad.exchange(0.f, std::memory_order_relaxed));
+
+    for (int signal = 0; signal < numSignals; ++signal)
+    {
+        peakProperties[(size_t) signal] = display(juce::Decibels::gainToDecibels(peak[(size_t) signal].exchange(0.f, std::memory_order_relaxed)));
+        rmsProperties[(size_t) signal] = display(juce::Decibels::gainToDecibels(rms[(size_t) signal].load(std::memory_order_relaxed)));
+    }
+}
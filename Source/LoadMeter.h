@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    LoadMeter.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    LoadMeter measures, on the audio thread, how much of each block's real-time
+    budget the processing took, and the peak and RMS level of the input, Mid,
+    Side and output signals. Once per block the results are published as
+    atomics; while an editor is open, a message thread timer copies them into
+    magicState properties ("meters/load", "meters/mid-rms"...) for the GUI to
+    show. The "meters" node is display only: the processor leaves it out of the
+    saved state.
+
+    Load is always measured, it costs two clock reads per block. Levels are only
+    measured while an editor is open. Peaks hold until the GUI has read them; RMS
+    is averaged with a 300 ms time constant, so it reads the same at any block size.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class LoadMeter : private juce::Timer
+{
+public:
+
+    enum Signal
+    {
+        input = 0,
+        mid,
+        side,
+        output,
+        numSignals
+    };
+
+    LoadMeter() = default;
+    ~LoadMeter() override;
+
+    // The property node the meters are published under
+    static constexpr const char* propertyNode = "meters";
+
+    // Message thread. setProperties binds the meters to state's property tree; call
+    // it again after that tree's children were replaced.
+    void prepare(double sampleRate);
+    void setProperties(foleys::MagicProcessorState& state);
+    void setEditorOpen(bool isOpen);
+
+    bool isMeasuringLevels() const noexcept { return editorOpen.load(std::memory_order_relaxed); }
+
+    //==============================================================================
+    // Audio thread, in this order every block
+
+    void beginBlock() noexcept;
+    void measure(Signal signal, const float* samples, int numSamples) noexcept;    // adds to this block's level
+    void measure(Signal signal, const double* samples, int numSamples) noexcept;
+    void endBlock(int numSamples) noexcept;
+
+private:
+
+    void timerCallback() override;
+
+    static void storeMax(std::atomic<float>& value, float newValue) noexcept;
+
+    template <typename SampleType>
+    void addLevel(Signal signal, const SampleType* samples, int numSamples) noexcept;
+
+    static constexpr int publishHz = 15;
+    static constexpr double rmsSeconds = 0.3;
+
+    double sampleRate = 44100.0;
+    juce::int64 blockStart = 0;
+
+    // This block's levels, audio thread only
+
+    std::array<float, numSignals> blockPeak {};
+    std::array<double, numSignals> blockSumOfSquares {};
+    std::array<int, numSignals> blockCount {};
+    std::array<double, numSignals> meanSquare {};   // ballistic, across blocks
+
+    // Published
+
+    std::atomic<float> load { 0.f }, peakLoad { 0.f };
+    std::array<std::atomic<float>, numSignals> peak {}, rms {};
+
+    std::atomic<bool> editorOpen { false };
+
+    // Message thread
+
+    juce::Value loadProperty, peakLoadProperty;
+    std::array<juce::Value, numSignals> peakProperties, rmsProperties;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoadMeter)
+};
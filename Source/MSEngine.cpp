@@ -0,0 +1,472 @@
+/*
+  ==============================================================================
+
+    MSEngine.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "MSEngine.h"
+
+namespace
+{
+    // Zeroed storage for size elements, only reallocated when the size changes
+    template <typename Type>
+    void allocateCleared(juce::HeapBlock<Type>& block, size_t& allocated, size_t size)
+    {
+        if (size != allocated)
+        {
+            block.calloc(size);
+            allocated = size;
+        }
+        else
+        {
+            block.clear(size);
+        }
+    }
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::prepare(int lanes, int maxTileSize, int maxDelaySamples, double newSampleRate)
+{
+    numLanes = lanes;
+    numVectors = (lanes + lanesPerVector - 1) / lanesPerVector;
+    sampleRate = newSampleRate;
+    tileSize = maxTileSize;
+
+    cutoffs.assign((size_t) numLanes, 1000.f);
+    resonances.assign((size_t) numLanes, 1.f / juce::MathConstants<float>::sqrt2);
+    sends.assign((size_t) numLanes, 0.f);
+    feedbacks.assign((size_t) numLanes, 0.f);
+    modes.assign((size_t) numLanes, lowpass);
+    laneActive.assign((size_t) numLanes, true);
+
+    for (auto* v : { &g, &R2, &h, &lowpassGain, &bandpassGain, &highpassGain, &s1, &s2 })
+        v->assign((size_t) numVectors, Vec::expand(SampleType(0)));
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        updateCoefficients(lane);
+
+    allocateCleared(interleavedStorage, interleavedAllocated, (size_t) (tileSize * numVectors * lanesPerVector + lanesPerVector));
+    interleaved = Vec::getNextSIMDAlignedPtr(interleavedStorage.get());
+
+    const int coefficientSize = tileSize * lanesPerVector;
+
+    allocateCleared(coefficientStorage, coefficientsAllocated, (size_t) (3 * coefficientSize + lanesPerVector));
+    gPerSample = Vec::getNextSIMDAlignedPtr(coefficientStorage.get());
+    R2PerSample = gPerSample + coefficientSize;
+    hPerSample = R2PerSample + coefficientSize;
+
+    delays.resize((size_t) numLanes);
+
+    for (auto& delay : delays)
+        delay.prepare(maxDelaySamples);
+
+    // Lanes on the pool each need their own wet scratch; in series they share one
+
+    const int scratchLanes = workers != nullptr ? numLanes : 1;
+
+    wet.setSize(scratchLanes, tileSize);
+
+    numTaps.assign((size_t) numLanes, 1);
+    tapGains.assign((size_t) numLanes, {});
+    tapPans.assign((size_t) numLanes, {});
+
+    tapWet.setSize(scratchLanes * (maxTaps - 1), tileSize);
+    crossWet.setSize(numLanes, tileSize);
+    hasCrossWet.assign((size_t) numLanes, 0);
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::reset()
+{
+    for (size_t v = 0; v < s1.size(); ++v)
+    {
+        s1[v] = Vec::expand(SampleType(0));
+        s2[v] = Vec::expand(SampleType(0));
+    }
+
+    for (auto& delay : delays)
+        delay.reset();
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::release()
+{
+    numLanes = numVectors = tileSize = 0;
+
+    for (auto* v : { &g, &R2, &h, &lowpassGain, &bandpassGain, &highpassGain, &s1, &s2 })
+        std::vector<Vec>().swap(*v);
+
+    interleavedStorage.free();
+    interleavedAllocated = 0;
+    interleaved = nullptr;
+
+    coefficientStorage.free();
+    coefficientsAllocated = 0;
+    gPerSample = R2PerSample = hPerSample = nullptr;
+
+    std::vector<DelayModule>().swap(delays);
+
+    wet.setSize(0, 0);
+    tapWet.setSize(0, 0);
+    crossWet.setSize(0, 0);
+}
+
+//==============================================================================
+
+template <typename SampleType>
+void MSEngine<SampleType>::setFilter(int lane, float cutoff, float resonance, FilterMode mode) noexcept
+{
+    jassert(juce::isPositiveAndBelow(lane, numLanes));
+
+    if (cutoffs[(size_t) lane] == cutoff && resonances[(size_t) lane] == resonance && modes[(size_t) lane] == mode)
+        return;
+
+    cutoffs[(size_t) lane] = cutoff;
+    resonances[(size_t) lane] = resonance;
+    modes[(size_t) lane] = mode;
+    updateCoefficients(lane);
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::setDelayMix(int lane, float send, float feedback) noexcept
+{
+    sends[(size_t) lane] = send;
+    feedbacks[(size_t) lane] = feedback;
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::setTaps(int lane, int taps, const float* gains, const float* pans) noexcept
+{
+    jassert(taps >= 1 && taps <= maxTaps);
+
+    numTaps[(size_t) lane] = taps;
+
+    for (int tap = 1; tap < taps; ++tap)
+    {
+        tapGains[(size_t) lane][(size_t) tap - 1] = gains[tap - 1];
+        tapPans[(size_t) lane][(size_t) tap - 1] = (lane ^ 1) < numLanes ? pans[tap - 1] : 0.f;
+    }
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::updateCoefficients(int lane) noexcept
+{
+    const auto v = (size_t) (lane / lanesPerVector);
+    const auto k = (size_t) (lane % lanesPerVector);
+
+    const auto cutoff = juce::jlimit(1.f, (float) (sampleRate * 0.49), cutoffs[(size_t) lane]);
+    const auto gValue = (SampleType) std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+    const auto R2Value = SampleType(1) / resonances[(size_t) lane];
+
+    g[v].set(k, gValue);
+    R2[v].set(k, R2Value);
+    h[v].set(k, SampleType(1) / (SampleType(1) + R2Value * gValue + gValue * gValue));
+
+    const auto mode = modes[(size_t) lane];
+    lowpassGain[v].set(k, mode == lowpass ? SampleType(1) : SampleType(0));
+    bandpassGain[v].set(k, mode == bandpass ? SampleType(1) : SampleType(0));
+    highpassGain[v].set(k, mode == highpass ? SampleType(1) : SampleType(0));
+}
+
+//==============================================================================
+
+template <typename SampleType>
+void MSEngine<SampleType>::computeCoefficients(int v, const float* const* cutoffs, const float* const* resonances, int numSamples) noexcept
+{
+    const auto pi = juce::MathConstants<float>::pi;
+    const auto maxCutoff = (float) (sampleRate * 0.49);
+    const auto piOverSampleRate = pi / (float) sampleRate;
+
+    for (int k = 0; k < lanesPerVector; ++k)
+    {
+        const int lane = v * lanesPerVector + k;
+
+        const float* cutoff = (cutoffs != nullptr && lane < numLanes) ? cutoffs[lane] : nullptr;
+        const float* resonance = (resonances != nullptr && lane < numLanes) ? resonances[lane] : nullptr;
+
+        SampleType* gOut = gPerSample + k;
+        SampleType* R2Out = R2PerSample + k;
+        SampleType* hOut = hPerSample + k;
+
+        // Static lanes of a modulated vector keep their coefficients
+
+        if (cutoff == nullptr && resonance == nullptr)
+        {
+            const SampleType gValue = g[(size_t) v].get((size_t) k), R2Value = R2[(size_t) v].get((size_t) k), hValue = h[(size_t) v].get((size_t) k);
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                gOut[sample * lanesPerVector] = gValue;
+                R2Out[sample * lanesPerVector] = R2Value;
+                hOut[sample * lanesPerVector] = hValue;
+            }
+
+            continue;
+        }
+
+        const SampleType staticG = g[(size_t) v].get((size_t) k);
+        const SampleType staticR2 = R2[(size_t) v].get((size_t) k);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const SampleType gValue = cutoff != nullptr ? (SampleType) fastTan(juce::jlimit(1.f, maxCutoff, cutoff[sample]) * piOverSampleRate) : staticG;
+            const SampleType R2Value = resonance != nullptr ? SampleType(1) / resonance[sample] : staticR2;
+
+            gOut[sample * lanesPerVector] = gValue;
+            R2Out[sample * lanesPerVector] = R2Value;
+            hOut[sample * lanesPerVector] = SampleType(1) / (SampleType(1) + R2Value * gValue + gValue * gValue);
+        }
+    }
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::filterStage(SampleType* const* lanes, const float* const* cutoffs, const float* const* resonances, int numSamples) noexcept
+{
+    jassert(numSamples <= tileSize);
+
+    const int stride = numVectors * lanesPerVector;
+
+    auto isActive = [&](int v)
+    {
+        for (int lane = v * lanesPerVector; lane < juce::jmin(numLanes, (v + 1) * lanesPerVector); ++lane)
+            if (laneActive[(size_t) lane])
+                return true;
+
+        return false;
+    };
+
+    // Interleave the lanes, so each sample of every vector is one aligned load
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        if (! isActive(lane / lanesPerVector))
+            continue;
+
+        const SampleType* source = lanes[lane];
+        SampleType* dest = interleaved + lane;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            dest[sample * stride] = source[sample];
+    }
+
+    // The TPT SVF, with every lane's output picked by its mode gains instead of a branch
+
+    auto isModulated = [&](int v)
+    {
+        for (int lane = v * lanesPerVector; lane < juce::jmin(numLanes, (v + 1) * lanesPerVector); ++lane)
+            if ((cutoffs != nullptr && cutoffs[lane] != nullptr) || (resonances != nullptr && resonances[lane] != nullptr))
+                return true;
+
+        return false;
+    };
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        if (! isActive(v))
+            continue;
+
+        const Vec lpGain = lowpassGain[(size_t) v], bpGain = bandpassGain[(size_t) v], hpGain = highpassGain[(size_t) v];
+
+        Vec state1 = s1[(size_t) v], state2 = s2[(size_t) v];
+        SampleType* frame = interleaved + v * lanesPerVector;
+
+        auto tick = [&](Vec x, Vec gv, Vec R2v, Vec hv)
+        {
+            const Vec yHP = hv * (x - state1 * (gv + R2v) - state2);
+
+            const Vec yBP = yHP * gv + state1;
+            state1 = yHP * gv + yBP;
+
+            const Vec yLP = yBP * gv + state2;
+            state2 = yBP * gv + yLP;
+
+            return yLP * lpGain + yBP * bpGain + yHP * hpGain;
+        };
+
+        if (isModulated(v))
+        {
+            computeCoefficients(v, cutoffs, resonances, numSamples);
+
+            for (int sample = 0; sample < numSamples; ++sample, frame += stride)
+            {
+                const int c = sample * lanesPerVector;
+
+                tick(Vec::fromRawArray(frame), Vec::fromRawArray(gPerSample + c),
+                     Vec::fromRawArray(R2PerSample + c), Vec::fromRawArray(hPerSample + c)).copyToRawArray(frame);
+            }
+        }
+        else
+        {
+            const Vec gv = g[(size_t) v], R2v = R2[(size_t) v], hv = h[(size_t) v];
+
+            for (int sample = 0; sample < numSamples; ++sample, frame += stride)
+                tick(Vec::fromRawArray(frame), gv, R2v, hv).copyToRawArray(frame);
+        }
+
+        s1[(size_t) v] = state1;
+        s2[(size_t) v] = state2;
+    }
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        if (! isActive(lane / lanesPerVector))
+            continue;
+
+        const SampleType* source = interleaved + lane;
+        SampleType* dest = lanes[lane];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            dest[sample] = source[sample * stride];
+    }
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::delayStage(SampleType* const* lanes, const float* const* delayTimes, const bool* timeIsStatic, const float* const* tapTimes,
+                                      const float* const* sendRamps, const float* const* feedbackRamps, int numSamples) noexcept
+{
+    // The lanes don't touch each other until the partner taps are mixed in, so
+    // with a pool each lane is one task
+
+    struct DelayJob : ChainWorkers::Job
+    {
+        DelayJob(MSEngine& e, SampleType* const* l, const float* const* d, const bool* s, const float* const* t,
+                 const float* const* sr, const float* const* fr, int n)
+            : engine(e), lanes(l), delayTimes(d), timeIsStatic(s), tapTimes(t), sendRamps(sr), feedbackRamps(fr), numSamples(n) {}
+
+        void runTask(int lane) noexcept override
+        {
+            engine.delayLane(lane, lanes[lane], delayTimes, timeIsStatic, tapTimes,
+                             sendRamps != nullptr ? sendRamps[lane] : nullptr,
+                             feedbackRamps != nullptr ? feedbackRamps[lane] : nullptr, numSamples);
+        }
+
+        MSEngine& engine;
+        SampleType* const* lanes;
+        const float* const* delayTimes;
+        const bool* timeIsStatic;
+        const float* const* tapTimes;
+        const float* const* sendRamps;
+        const float* const* feedbackRamps;
+        int numSamples;
+    };
+
+    DelayJob job(*this, lanes, delayTimes, timeIsStatic, tapTimes, sendRamps, feedbackRamps, numSamples);
+
+    if (workers != nullptr)
+        workers->run(job, numLanes);
+    else
+        for (int lane = 0; lane < numLanes; ++lane)
+            job.runTask(lane);
+
+    // Once every lane has its own mix, the panned taps land in their partner. A
+    // silent partner is cleared by the gates, so it takes them as they are.
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        if (hasCrossWet[(size_t) lane])
+            juce::FloatVectorOperations::add(lanes[lane ^ 1], crossWet.getReadPointer(lane), numSamples);
+}
+
+template <typename SampleType>
+void MSEngine<SampleType>::delayLane(int lane, SampleType* signal, const float* const* delayTimes, const bool* timeIsStatic, const float* const* tapTimes,
+                                     const float* sendRamp, const float* feedbackRamp, int numSamples) noexcept
+{
+    hasCrossWet[(size_t) lane] = 0;
+
+    if (! laneActive[(size_t) lane])
+        return;
+
+    auto* wetSignal = wet.getWritePointer(workers != nullptr ? lane : 0);
+    const float* times = timeIsStatic[lane] ? nullptr : delayTimes[lane];
+
+    // Read a delayed sample, write the filtered sample + feedback, then Dry + Wet
+
+    const int taps = numTaps[(size_t) lane];
+
+    if (taps > 1)
+        processTaps(lane, signal, wetSignal, delayTimes, timeIsStatic, tapTimes, feedbackRamp, numSamples);
+    else if (feedbackRamp != nullptr)
+        delays[(size_t) lane].process(signal, wetSignal, times, delayTimes[lane][0], feedbackRamp, numSamples);
+    else
+        delays[(size_t) lane].process(signal, wetSignal, times, delayTimes[lane][0], feedbacks[(size_t) lane], numSamples);
+
+    // The panned part of the taps goes through the same send, to the partner lane
+
+    if (hasCrossWet[(size_t) lane])
+    {
+        auto* cross = crossWet.getWritePointer(lane);
+
+        if (sendRamp != nullptr)
+            for (int sample = 0; sample < numSamples; ++sample)
+                cross[sample] *= sendRamp[sample];
+        else
+            juce::FloatVectorOperations::multiply(cross, (SampleType) sends[(size_t) lane], numSamples);
+    }
+
+    if (sendRamp != nullptr)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+            signal[sample] = (signal[sample] * (sendRamp[sample] - 1)) + (wetSignal[sample] * sendRamp[sample]);
+    }
+    else
+    {
+        const float send = sends[(size_t) lane];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            signal[sample] = (signal[sample] * (send - 1)) + (wetSignal[sample] * send);
+    }
+}
+
+//==============================================================================
+
+template <typename SampleType>
+void MSEngine<SampleType>::processTaps(int lane, const SampleType* signal, SampleType* wetSignal, const float* const* delayTimes, const bool* timeIsStatic,
+                                       const float* const* tapTimes, const float* feedbackRamp, int numSamples) noexcept
+{
+    const int taps = numTaps[(size_t) lane];
+
+    SampleType* outputs[maxTaps] = { wetSignal };
+    const float* times[maxTaps] = { delayTimes[lane] };
+
+    for (int tap = 1; tap < taps; ++tap)
+    {
+        outputs[tap] = tapWet.getWritePointer((workers != nullptr ? lane * (maxTaps - 1) : 0) + tap - 1);
+        times[tap] = tapTimes[tapIndex(lane, tap)];
+    }
+
+    delays[(size_t) lane].processTaps(signal, outputs, times, timeIsStatic[lane], taps, feedbackRamp, feedbacks[(size_t) lane], numSamples);
+
+    // Tap 0 is the wet signal already; the others are mixed in at their gain, and
+    // at gain * pan into the partner's share
+
+    auto* cross = crossWet.getWritePointer(lane);
+    bool crossStarted = false;
+
+    for (int tap = 1; tap < taps; ++tap)
+    {
+        const auto gain = (SampleType) tapGains[(size_t) lane][(size_t) tap - 1];
+        const auto pan = (SampleType) tapPans[(size_t) lane][(size_t) tap - 1];
+
+        juce::FloatVectorOperations::addWithMultiply(wetSignal, outputs[tap], gain, numSamples);
+
+        if (pan == SampleType(0))
+            continue;
+
+        if (crossStarted)
+            juce::FloatVectorOperations::addWithMultiply(cross, outputs[tap], gain * pan, numSamples);
+        else
+            juce::FloatVectorOperations::copyWithMultiply(cross, outputs[tap], gain * pan, numSamples);
+
+        crossStarted = true;
+    }
+
+    hasCrossWet[(size_t) lane] = crossStarted ? 1 : 0;
+}
+
+//==============================================================================
+
+template class MSEngine<float>;
+template class MSEngine<double>;
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    MSEngine.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    MSEngine runs the Mid and Side chains (filter -> feedback delay -> send mix)
+    as lanes of one engine instead of two sets of separate modules.
+
+    The state variable filters are the recursive part that can't be vectorised
+    over time, so their state lives interleaved in SIMD registers, one lane per
+    chain, and both chains are filtered together as one vector: lane 0 is Mid,
+    lane 1 is Side. The filter is the same topology-preserving SVF as
+    juce::dsp::StateVariableTPTFilter.
+
+    Cutoff and resonance can move every sample. A vector with a modulated lane
+    gets its coefficients computed per sample first, with a folded Pade tan
+    instead of std::tan (within a few ppm up to Nyquist), in plain loops over
+    time that vectorise; the recursive part then reads them like the static ones.
+
+    Each lane keeps its own EchoDelay, since every lane reads at its own
+    fractional position; the delay runs through EchoDelay's block kernel and
+    the send mix runs over the whole tile.
+
+    A lane can read up to maxTaps taps from its one delay line. Tap 0 is the
+    main echo, the one that feeds back; the others are added to the wet signal
+    with their own gain, and their pan sends part of them to the lane's partner
+    (Mid <-> Side), which places them left or right once decoded. Memory stays
+    the same, extra taps only cost their reads.
+
+    The engine is templated on the sample type of the signal: MSEngine<float>
+    fills four lanes per SSE/NEON register, MSEngine<double> two. Delay times,
+    cutoffs and the send/feedback ramps are float control signals for both.
+
+    Offline, the lanes of delayStage can be spread over a ChainWorkers pool: each
+    lane then gets its own wet scratch, and the partner taps are mixed in once
+    every lane is done. The filter stays on the calling thread, since its lanes
+    share SIMD registers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EchoDelay.h"
+#include "ChainWorkers.h"
+
+// What doesn't depend on the sample type
+struct MSEngineBase
+{
+    static constexpr int maxTaps = 4;
+
+    // Index of tap (1 .. maxTaps - 1) of lane in the tapTimes given to delayStage
+    static constexpr int tapIndex(int lane, int tap) noexcept { return lane * (maxTaps - 1) + tap - 1; }
+
+    enum FilterMode { lowpass = 0, bandpass, highpass };
+
+    //==============================================================================
+    // Cheap math for per-sample coefficients
+
+    // tan(x) for 0 <= x < pi/2
+    static float fastTan(float x) noexcept
+    {
+        constexpr float quarterPi = juce::MathConstants<float>::pi / 4, halfPi = juce::MathConstants<float>::halfPi;
+
+        // [5/4] Pade around 0, folded with tan(x) = 1 / tan(pi/2 - x) above pi/4
+
+        const bool folded = x > quarterPi;
+        const float y = folded ? halfPi - x : x;
+        const float y2 = y * y;
+        const float t = y * (945.f - 105.f * y2 + y2 * y2) / (945.f - 420.f * y2 + 15.f * y2 * y2);
+
+        return folded ? 1.f / t : t;
+    }
+
+    // 2^x, for cutoff modulation in octaves
+    static float fastExp2(float x) noexcept
+    {
+        const float whole = std::floor(x);
+        const float f = x - whole;
+        const float p = 1.f + f * (0.693147f + f * (0.240227f + f * (0.0555041f + f * (0.00961813f + f * 0.00133336f))));
+
+        return std::ldexp(p, (int) whole);
+    }
+};
+
+//==============================================================================
+
+template <typename SampleType>
+class MSEngine : public MSEngineBase
+{
+public:
+
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    using DelayModule = EchoDelay<SampleType, EchoDelayInterpolation::Lagrange3rd>;
+
+    static constexpr int lanesPerVector = (int) Vec::SIMDNumElements;
+
+    // Allocates what the lanes need; preparing again with the same sizes keeps
+    // the buffers and only clears them. Call from prepareToPlay
+    void prepare(int numLanes, int maxTileSize, int maxDelaySamples, double sampleRate);
+    void reset();
+
+    // Frees every buffer, for a signal path the host stopped using
+    void release();
+
+    // Pool delayStage spreads its lanes over, or null to run them in series. Call
+    // before prepare, which sizes the scratch for it.
+    void setWorkers(ChainWorkers* newWorkers) noexcept  { workers = newWorkers; }
+
+    int getNumLanes() const noexcept { return numLanes; }
+
+    // Per block, from the audio thread
+    void setFilter(int lane, float cutoff, float resonance, FilterMode mode) noexcept;
+    void setDelayMix(int lane, float send, float feedback) noexcept;
+
+    // Taps 1 .. numTaps - 1 of a lane; gains and pans hold numTaps - 1 values. Pan
+    // goes from -1 to 1 and is ignored on a lane without a partner.
+    void setTaps(int lane, int numTaps, const float* gains, const float* pans) noexcept;
+
+    // Inactive lanes are skipped by both stages and keep their state; a vector whose
+    // lanes are all inactive isn't filtered at all
+    void setLaneActive(int lane, bool shouldBeActive) noexcept   { laneActive[(size_t) lane] = shouldBeActive; }
+
+    // Stages. lanes holds numLanes buffers of numSamples that are processed in place.
+    // delayTimes[lane] is the per-sample delay time; with timeIsStatic[lane] set only
+    // delayTimes[lane][0] is read. tapTimes[tapIndex(lane, tap)] are those of the
+    // extra taps, read the same way. sends/feedbacks are optional per-sample ramps per
+    // lane; a null array or lane uses the value from setDelayMix.
+    // cutoffs/resonances are optional per-sample values per lane (Hz, Q); a null
+    // array or lane uses the values from setFilter.
+    void filterStage(SampleType* const* lanes, const float* const* cutoffs, const float* const* resonances, int numSamples) noexcept;
+    void delayStage(SampleType* const* lanes, const float* const* delayTimes, const bool* timeIsStatic, const float* const* tapTimes,
+                    const float* const* sendRamps, const float* const* feedbackRamps, int numSamples) noexcept;
+
+private:
+
+    void updateCoefficients(int lane) noexcept;
+    void computeCoefficients(int vector, const float* const* cutoffs, const float* const* resonances, int numSamples) noexcept;
+    void delayLane(int lane, SampleType* signal, const float* const* delayTimes, const bool* timeIsStatic, const float* const* tapTimes,
+                   const float* sendRamp, const float* feedbackRamp, int numSamples) noexcept;
+    void processTaps(int lane, const SampleType* signal, SampleType* wetSignal, const float* const* delayTimes, const bool* timeIsStatic,
+                     const float* const* tapTimes, const float* feedbackRamp, int numSamples) noexcept;
+
+    int numLanes = 0, numVectors = 0;
+    double sampleRate = 44100.0;
+
+    // Per lane parameters, copied into the coefficient vectors when they change
+
+    std::vector<float> cutoffs, resonances, sends, feedbacks;
+    std::vector<FilterMode> modes;
+    std::vector<bool> laneActive;
+
+    // Interleaved per vector: lane k of vector v is lane v * lanesPerVector + k
+
+    std::vector<Vec> g, R2, h;                  // SVF coefficients
+    std::vector<Vec> lowpassGain, bandpassGain, highpassGain;
+    std::vector<Vec> s1, s2;                    // SVF state
+
+    juce::HeapBlock<SampleType> interleavedStorage;
+    size_t interleavedAllocated = 0;
+    SampleType* interleaved = nullptr;          // SIMD-aligned, [sample][vector][lane]
+
+    juce::HeapBlock<SampleType> coefficientStorage;
+    size_t coefficientsAllocated = 0;
+    SampleType* gPerSample = nullptr;           // SIMD-aligned, [sample][lane] of one vector
+    SampleType* R2PerSample = nullptr;
+    SampleType* hPerSample = nullptr;
+    int tileSize = 0;
+
+    std::vector<DelayModule> delays;
+    juce::AudioBuffer<SampleType> wet;
+
+    // Taps, per lane: count, then gain and pan of taps 1 .. maxTaps - 1
+
+    std::vector<int> numTaps;
+    std::vector<std::array<float, maxTaps - 1>> tapGains, tapPans;
+
+    juce::AudioBuffer<SampleType> tapWet;            // taps 1 .. maxTaps - 1 of the lane being processed (of each lane, with workers)
+    juce::AudioBuffer<SampleType> crossWet;          // what each lane's panned taps send to its partner
+    std::vector<char> hasCrossWet;              // not vector<bool>: lanes on different threads write it
+
+    ChainWorkers* workers = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MSEngine)
+};
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    MSKernels.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    Mid/Side encode and decode kernels for one L/R pair, generated per Input and
+    Output type at compile time. The processor picks the kernels once per block,
+    so the per-sample loops carry no I/O branches.
+
+    The Stereo i/o volume compensation (-6 dB at width 0, -4 dB at width 2) is
+    given to decode as a gain ramp the processor computes once per tile.
+
+    The kernels are templated on the sample type of the signal; width and gain
+    are float ramps for both.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace MSKernels
+{
+    template <typename SampleType>
+    using EncodeKernel = void (*) (const SampleType* left, const SampleType* right, SampleType* mid, SampleType* side, const float* width, int numSamples);
+
+    template <typename SampleType>
+    using DecodeKernel = void (*) (const SampleType* mid, const SampleType* side, SampleType* left, SampleType* right, const float* gain, int numSamples);
+
+    // Mid/Side encoding and Stereo Widening, or simply a Mid/Side mixer if the input is Mid/Side
+    template <typename SampleType, bool stereoInput>
+    void encode(const SampleType* left, const SampleType* right, SampleType* mid, SampleType* side, const float* width, int numSamples)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const SampleType l = left[sample], r = right[sample];
+            const SampleType w = width[sample];
+
+            mid[sample] = SampleType(0.5) * (2 - w) * (stereoInput ? l + r : l);
+            side[sample] = SampleType(0.5) * w * (stereoInput ? l - r : r);
+        }
+    }
+
+    // Stereo output decodes (with the volume gain when the input was Stereo too);
+    // Mid/Side output leaves Mid in Left and Side in Right
+    template <typename SampleType, bool stereoInput, bool stereoOutput>
+    void decode(const SampleType* mid, const SampleType* side, SampleType* left, SampleType* right, const float* gain, int numSamples)
+    {
+        if (! stereoOutput)
+        {
+            juce::FloatVectorOperations::copy(left, mid, numSamples);
+            juce::FloatVectorOperations::copy(right, side, numSamples);
+            return;
+        }
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const SampleType g = stereoInput ? (SampleType) gain[sample] : SampleType(1);
+
+            left[sample] = (mid[sample] + side[sample]) * g;
+            right[sample] = (mid[sample] - side[sample]) * g;
+        }
+    }
+
+    template <typename SampleType>
+    EncodeKernel<SampleType> getEncodeKernel(bool stereoInput) noexcept
+    {
+        return stereoInput ? &encode<SampleType, true> : &encode<SampleType, false>;
+    }
+
+    template <typename SampleType>
+    DecodeKernel<SampleType> getDecodeKernel(bool stereoInput, bool stereoOutput) noexcept
+    {
+        static constexpr DecodeKernel<SampleType> kernels[2][2] = { { &decode<SampleType, false, false>, &decode<SampleType, false, true> },
+                                                                    { &decode<SampleType, true, false>,  &decode<SampleType, true, true> } };
+        return kernels[stereoInput ? 1 : 0][stereoOutput ? 1 : 0];
+    }
+
+    // Volume compensation for a width: 0 dB at 1, down to -6 dB at 0 and to -4 dB at 2
+    inline float widthGain(float width) noexcept
+    {
+        const float volumeScale = width <= 1.f ? juce::jmap(width, 1.0f, 0.0f, 0.0f, -6.0f)
+                                               : juce::jmap(width, 1.0f, 0.0f, 0.0f, 4.f);
+        return juce::Decibels::decibelsToGain(volumeScale);
+    }
+
+    // Fills gain for a width ramp. The gain law is smooth, so it is evaluated at the
+    // ends of the tile and interpolated in between; a constant width costs one pow.
+    inline void fillWidthGain(float* gain, const float* width, bool widthIsRamping, int numSamples) noexcept
+    {
+        const float first = widthGain(width[0]);
+
+        if (! widthIsRamping || numSamples == 1)
+        {
+            juce::FloatVectorOperations::fill(gain, first, numSamples);
+            return;
+        }
+
+        const float step = (widthGain(width[numSamples - 1]) - first) / (float) (numSamples - 1);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            gain[sample] = first + step * (float) sample;
+    }
+}
@@ -15,27 +15,28 @@
   potentially be initialized appropriately by passing the juce::dsp::ProcessSpec
   spec onto the prepare function.
 
-  The member variable m_sampleRate is, however, shared among all instances of the
-  class. Meaning the sample rate needs to be passed only to one instance of it.
-  Declaring it again will not results in more errors, but'll take unnecessary space.
+  Each instance keeps its own sample rate.
   
   ==============================================================================
 */
 
 #include "Osc.h"
 
-double Osc::m_sampleRate;
+#include <algorithm>
+#include <array>
+#include <vector>
 
 void Osc::prepare(double sR)
 {
     m_sampleRate = sR;
+    m_wavetables();     // built on first use; keep that off the audio thread
 }
 
 #ifdef JUCE_HEADER_INCLUDED
 void Osc::prepare(const juce::dsp::ProcessSpec& spec)
 {
     jassert(spec.sampleRate > 0);
-    m_sampleRate = spec.sampleRate;
+    prepare(spec.sampleRate);
 }
 #endif
 
@@ -44,6 +45,33 @@ void Osc::setWaveform(Waveform waveform)
     m_waveform = waveform;
 }
 
+void Osc::setSeed(uint64_t seed, uint64_t stream)
+{
+    m_random.setSeed(seed, stream);
+}
+
+void Osc::reset()
+{
+    m_phase = 0;
+    m_out = 0;
+    m_sampler = 0;
+}
+
+void Osc::setPhase(double phase)
+{
+    m_phase = std::remainder(phase, 2 * M_PI);
+}
+
+void Osc::skip(double speed, int numSamples)
+{
+    const double phase = m_phase + (2 * M_PI) * speed * numSamples / m_sampleRate;
+
+    if (phase > M_PI)
+        m_sampler = 1;      // Random and Sample & Hold take a new value on the next sample
+
+    m_phase = std::remainder(phase, 2 * M_PI);
+}
+
 double Osc::output(double speed, double depth)
 {
     m_speed = speed;
@@ -138,12 +166,265 @@ void Osc::m_calculatePhase()
 
 double Osc::m_randomDouble()
 {
-    //generate seed
-    std::random_device rd;
-    std::seed_seq sd{rd(), rd(), rd(), rd()};
-    
-    //generate random double
-    static std::mt19937 gen(sd);
-    static std::uniform_real_distribution<double> dis(-1.0, 1.0);
-    return dis(gen);
-}
\ No newline at end of file
+    return m_random.nextBipolar();
+}
+
+//==============================================================================
+// Band-limited wavetables
+
+struct Osc::Wavetables
+{
+    enum Shape { triangle = 0, sawtooth, square, numShapes };
+
+    // Level l holds harmonics 1 .. maxHarmonics >> l, in a table of at least four
+    // samples per cycle of its top harmonic so linear interpolation stays clean.
+    // Below sampleRate / naiveSpeedDivisor the naive shapes are used instead.
+
+    static constexpr int maxHarmonics = 1024;
+    static constexpr int numLevels = 11;
+    static constexpr int minSize = 64;
+    static constexpr int naiveSpeedDivisor = 4 * maxHarmonics;
+
+    static int sizeOf(int level) noexcept { return std::max(minSize, 4 * (maxHarmonics >> level)); }
+
+    Wavetables();
+
+    const float* get(int shape, int level) const noexcept { return data.data() + offsets[(size_t) shape][(size_t) level]; }
+
+private:
+
+    std::vector<float> data;    // every table has one guard sample, a copy of its first
+    std::array<std::array<int, numLevels>, numShapes> offsets;
+};
+
+Osc::Wavetables::Wavetables()
+{
+    int total = 0;
+
+    for (auto& shapeOffsets : offsets)
+    {
+        for (int level = 0; level < numLevels; ++level)
+        {
+            shapeOffsets[(size_t) level] = total;
+            total += sizeOf(level) + 1;
+        }
+    }
+
+    data.assign((size_t) total, 0.f);
+
+    // Fourier series of the naive shapes, indexed by (phase + pi) / 2pi so a table
+    // lines up with the shape it replaces: Triangle is a cosine series of the odd
+    // harmonics, Sawtooth and Square (odd harmonics only) are falling sine series.
+
+    std::vector<double> sine, sum;
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        const int size = sizeOf(level);
+        const int harmonics = maxHarmonics >> level;
+
+        sine.resize((size_t) size);
+
+        for (int i = 0; i < size; ++i)
+            sine[(size_t) i] = std::sin(2 * M_PI * i / size);
+
+        for (int shape = 0; shape < numShapes; ++shape)
+        {
+            sum.assign((size_t) size, 0.0);
+
+            for (int k = 1; k <= harmonics; ++k)
+            {
+                if (shape != sawtooth && k % 2 == 0)
+                    continue;
+
+                const double amplitude = shape == triangle ? 8 / (M_PI * M_PI * k * k)
+                                       : shape == sawtooth ? -1 / (M_PI * k)
+                                                           : -4 / (M_PI * k);
+                const int quarter = shape == triangle ? size / 4 : 0;   // cosine
+
+                for (int i = 0; i < size; ++i)
+                    sum[(size_t) i] += amplitude * sine[(size_t) ((k * i + quarter) & (size - 1))];
+            }
+
+            auto* table = data.data() + offsets[(size_t) shape][(size_t) level];
+
+            for (int i = 0; i < size; ++i)
+                table[i] = (float) sum[(size_t) i];
+
+            table[size] = table[0];
+        }
+    }
+}
+
+const Osc::Wavetables& Osc::m_wavetables()
+{
+    static const Wavetables tables;
+    return tables;
+}
+
+bool Osc::m_renderBandLimited(float* dest, const float* speed, int numSamples, int shape)
+{
+    float maxSpeed = 0.f;
+
+    for (int i = 0; i < numSamples; ++i)
+        maxSpeed = std::max(maxSpeed, speed[i]);
+
+    // Slow enough that the naive shape keeps its corners without audible aliasing
+
+    if (maxSpeed * Wavetables::naiveSpeedDivisor <= m_sampleRate)
+        return false;
+
+    // The first level whose top harmonic stays below Nyquist at the fastest speed
+
+    const double harmonicsBelowNyquist = 0.5 * m_sampleRate / maxSpeed;
+    int level = 0;
+
+    while (level < Wavetables::numLevels - 1 && (Wavetables::maxHarmonics >> level) > harmonicsBelowNyquist)
+        ++level;
+
+    const int size = Wavetables::sizeOf(level);
+    const float* table = m_wavetables().get(shape, level);
+    const float scale = (float) size / (float) (2 * M_PI);
+    const float centre = 0.5f * (float) size;
+
+    // Branch-free linear interpolation; index and fraction are plain arithmetic,
+    // so the loop vectorises up to the table reads
+
+    m_renderShape(dest, speed, numSamples, [=](float p)
+    {
+        const float position = std::max(p * scale + centre, 0.f);
+        const int index = std::min((int) position, size - 1);
+        const float fraction = position - (float) index;
+
+        return table[index] + fraction * (table[index + 1] - table[index]);
+    });
+
+    return true;
+}
+
+//==============================================================================
+// Block rendering
+
+void Osc::renderBlock(float* dest, const float* speed, const float* depth, const float* input, int numSamples)
+{
+    m_renderBlock(dest, speed, depth, input, numSamples);
+}
+
+void Osc::renderBlock(float* dest, const float* speed, const float* depth, const double* input, int numSamples)
+{
+    m_renderBlock(dest, speed, depth, input, numSamples);
+}
+
+template <typename InputType>
+void Osc::m_renderBlock(float* dest, const float* speed, const float* depth, const InputType* input, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    constexpr float pi = (float) M_PI;
+
+    // One switch per block; the per-sample shaping loops are branch-free so they vectorise
+
+    switch (m_waveform)
+    {
+    case Sine:
+        m_renderShape(dest, speed, numSamples, [](float p) { return fastSin(p); });
+        break;
+
+    case Triangle:
+        if (! m_renderBandLimited(dest, speed, numSamples, Wavetables::triangle))
+            m_renderShape(dest, speed, numSamples, [](float p) { return -1.f + (2.f / pi) * std::abs(p); });
+        break;
+
+    case Sawtooth:
+        if (! m_renderBandLimited(dest, speed, numSamples, Wavetables::sawtooth))
+            m_renderShape(dest, speed, numSamples, [](float p) { return p * (1.f / (2.f * pi)); });
+        break;
+
+    case Square:
+        if (! m_renderBandLimited(dest, speed, numSamples, Wavetables::square))
+            m_renderShape(dest, speed, numSamples, [](float p) { return p > 0.f ? 1.f : -1.f; });
+        break;
+
+    case Random:
+    case SH:
+        m_renderHeld(dest, speed, input, numSamples);
+        break;
+    }
+
+    m_speed = speed[numSamples - 1];
+
+    if (depth == nullptr)
+        return;
+
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] *= depth[i];
+
+    m_depth = depth[numSamples - 1];
+}
+
+float Osc::m_advancePhase(const float* speed, float* phases, int numSamples)
+{
+    // Writes the phase each sample is evaluated at, then advances it (as output() does).
+    // Returns the phase of the last sample.
+
+    const double phasePerHz = (2 * M_PI) / m_sampleRate;
+    double phase = m_phase;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        phases[i] = (float) phase;
+        phase += phasePerHz * speed[i];
+
+        if (phase > M_PI)
+        {
+            phase -= (2 * M_PI);
+            m_sampler = 1;
+        }
+    }
+
+    m_phase = phase;
+    return phases[numSamples - 1];
+}
+
+template <typename Shape>
+void Osc::m_renderShape(float* dest, const float* speed, int numSamples, Shape shape)
+{
+    const float lastPhase = m_advancePhase(speed, dest, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] = shape(dest[i]);
+
+    m_out = shape(lastPhase);
+}
+
+template <typename InputType>
+void Osc::m_renderHeld(float* dest, const float* speed, const InputType* input, int numSamples)
+{
+    // Random and Sample & Hold only change value at the sample after a phase wrap
+
+    const double phasePerHz = (2 * M_PI) / m_sampleRate;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (m_sampler == 1)
+        {
+            if (m_waveform == Random)
+                m_out = m_randomDouble();
+            else if (input != nullptr)
+                m_out = input[i];
+
+            m_sampler = 0;
+        }
+
+        dest[i] = (float) m_out;
+
+        m_phase += phasePerHz * speed[i];
+
+        if (m_phase > M_PI)
+        {
+            m_phase -= (2 * M_PI);
+            m_sampler = 1;
+        }
+    }
+}
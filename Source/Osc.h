@@ -5,7 +5,7 @@
 
   Osc is an oscillator class containing a variety of waveforms (Sine, Triangle,
   Sawtooth, Square and Random), apart from Sample & Hold capabilities by sampling
-  said Random waveform.
+  said Random waveform. Random values come from a per-instance seeded generator.
 
   Computation of oscillator values in relation to phase is heavily influenced by
   Bela's Andrew McPherson's "C++ Real-Time Audio Programming with Bela" Series.
@@ -23,9 +23,16 @@
 
 /*
 
-  The member variable m_sampleRate is, however, shared among all instances of the
-  class. Meaning the sample rate needs to be passed only to one instance of it.
-  Declaring it again will not results in more errors, but'll take unnecessary space.
+  Each instance keeps its own sample rate, so instances running at different
+  rates don't affect each other. renderBlock fills a whole block at once from
+  per-sample speed/depth ramps, choosing the waveform once per block.
+
+  At LFO speeds renderBlock computes Triangle, Sawtooth and Square directly from
+  the phase. Pushed into the audio range those corners alias, so above
+  sampleRate / 4096 it reads them from band-limited wavetables instead: one set
+  per process, shared by every instance, with a mip level per octave of speed
+  holding only the harmonics that stay below Nyquist. The level is picked once
+  per block from the fastest speed in it.
 
   ==============================================================================
 */
@@ -34,7 +41,7 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
-#include <random>
+#include "FastRandom.h"
 
 #ifdef JUCE_HEADER_INCLUDED
 #include <JuceHeader.h>
@@ -57,39 +64,50 @@ class Osc
 
 private:
 
-        static double m_sampleRate;
+        double m_sampleRate;
         double m_phase, m_speed, m_depth, m_out, m_in;
         Waveform m_waveform;
         bool m_sampler = 0;
+        FastRandom m_random;
         
         void m_calculatePhase();
         double m_randomDouble();
         void m_waveSwitch();
 
+        float m_advancePhase(const float* speed, float* phases, int numSamples);
+
+        template <typename Shape>
+        void m_renderShape(float* dest, const float* speed, int numSamples, Shape shape);
+
+        struct Wavetables;
+        static const Wavetables& m_wavetables();
+        bool m_renderBandLimited(float* dest, const float* speed, int numSamples, int shape);
+
+        template <typename InputType>
+        void m_renderBlock(float* dest, const float* speed, const float* depth, const InputType* input, int numSamples);
+
+        template <typename InputType>
+        void m_renderHeld(float* dest, const float* speed, const InputType* input, int numSamples);
     public:
         
         Osc()
-            : m_out(0), m_phase(0), m_speed(0), m_depth(0), m_waveform(Sine)
+            : m_sampleRate(0), m_phase(0), m_speed(0), m_depth(0), m_out(0), m_in(0), m_waveform(Sine)
         {
-            m_sampleRate = 0;
         }
 
         Osc(double sR)
-            : m_out(0), m_phase(0), m_speed(0), m_depth(0), m_waveform(Sine)
+            : m_sampleRate(sR), m_phase(0), m_speed(0), m_depth(0), m_out(0), m_in(0), m_waveform(Sine)
         {
-            m_sampleRate = sR;
         }
 
         Osc(Waveform waveform)
-            : m_out(0), m_phase(0), m_speed(0), m_depth(0), m_waveform(waveform)
+            : m_sampleRate(0), m_phase(0), m_speed(0), m_depth(0), m_out(0), m_in(0), m_waveform(waveform)
         {
-            m_sampleRate = 0;
         }
 
         Osc(double sR, Waveform waveform)
-            : m_out(0), m_phase(0), m_speed(0), m_depth(0), m_waveform(waveform)
+            : m_sampleRate(sR), m_phase(0), m_speed(0), m_depth(0), m_out(0), m_in(0), m_waveform(waveform)
         {
-            m_sampleRate = sR;
         }
  
         void prepare(double sR);
@@ -100,6 +118,42 @@ private:
         
         void setWaveform(Waveform waveform);
 
+        // Restarts the Random waveform's sequence; the same seed and stream give the same output
+        void setSeed(uint64_t seed, uint64_t stream = 0);
+
+        // Back to phase 0 and a silent output, as on construction
+        void reset();
+
+        // Phase in [-pi, pi]; used to keep several oscillators at fixed offsets
+        void setPhase(double phase);
+        double getPhase() const noexcept { return m_phase; }
+
+        // Advances the phase by numSamples at a constant speed without rendering,
+        // for an oscillator whose output isn't needed for a while
+        void skip(double speed, int numSamples);
+
         double output(double speed, double depth);
         double output(double speed, double depth, float * input);
+
+        // Block rendering: dest[i] = waveform * depth[i], with the phase advanced by
+        // speed[i] (Hz) every sample. A null depth leaves the waveform at +-1. input
+        // is only read by Sample & Hold and may be null for the other waveforms.
+        // dest may not alias the other buffers. The output is float either way; the
+        // input follows the sample type of the signal being sampled.
+        void renderBlock(float* dest, const float* speed, const float* depth, const float* input, int numSamples);
+        void renderBlock(float* dest, const float* speed, const float* depth, const double* input, int numSamples);
+
+        // Sine approximation for phase in [-pi, pi], max error around 4e-6
+        static inline float fastSin(float phase) noexcept
+        {
+            constexpr float pi = (float) M_PI;
+            constexpr float halfPi = (float) (M_PI / 2);
+
+            // Fold onto [-pi/2, pi/2]; both selects compile to blends
+            float x = phase > halfPi ? pi - phase : phase;
+            x = x < -halfPi ? -pi - x : x;
+
+            const float x2 = x * x;
+            return x * (1.f + x2 * (-1.f / 6.f + x2 * (1.f / 120.f + x2 * (-1.f / 5040.f + x2 * (1.f / 362880.f)))));
+        }
 };
\ No newline at end of file
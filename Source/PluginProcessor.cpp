@@ -8,6 +8,8 @@
 
 #include "PluginProcessor.h"
 #include "PresetListBox.h"
+#include "RealtimeGuard.h"
+#include "Profiler.h"
 
 
 //==============================================================================
@@ -30,55 +32,39 @@ Ek0Ka0sAudioProcessor::Ek0Ka0sAudioProcessor()
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
         treeState(*this, nullptr, ProjectInfo::projectName, createParameterLayout())
 {
+        parameterCache.attach(treeState);
 
         FOLEYS_SET_SOURCE_PATH(__FILE__);
 
-        auto file = juce::File::getSpecialLocation(juce::File::currentApplicationFile)
-        .getChildFile("Contents")
-        .getChildFile("Resources")
-        .getChildFile("magic.xml");
-    
-        if (file.existsAsFile())
-        magicState.setGuiValueTree(file);
-        //else
-        //magicState.setGuiValueTree(BinaryData::magic_xml, BinaryData::magic_xmlSize);
+        // The GUI layout and the objects only the editor uses wait for createEditor
 
-        /*
-        // MAGIC GUI: add a meter at the output
-        outputMeter = magicState.createAndAddObject<foleys::MagicLevelSource>("output");
-        oscilloscope = magicState.createAndAddObject<foleys::MagicOscilloscope>("waveform");
+        // MAGIC GUI: CPU load and levels, published as "meters/..." properties
+        loadMeter.setProperties(magicState);
 
-        analyser = magicState.createAndAddObject<foleys::MagicAnalyser>("analyser");
-        magicState.addBackgroundProcessing(analyser);
-        */
+        // Shared settings also hold the presets older versions saved, which the bank imports
+        magicState.setApplicationSettingsFile(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile(ProjectInfo::companyName)
+            .getChildFile(ProjectInfo::projectName + juce::String(".settings")));
 
-        //MAGIC GUI STUFF======================================
+        // LFO seed: a fresh one per new instance, replaced by the saved one on restore
 
-        midOscilloscope = magicState.createAndAddObject<foleys::MagicOscilloscope>("midOsc");
-        sideOscilloscope = magicState.createAndAddObject<foleys::MagicOscilloscope>("sideOsc");
+        lfoSeed.referTo(magicState.getPropertyAsValue("lfo-seed"));
 
-        //=====================================================
+        if (lfoSeed.getValue().isVoid())
+            setLfoSeed(juce::Random::getSystemRandom().nextInt64());
 
-        presetList = magicState.createAndAddObject<PresetListBox>("presets");
-        presetList->onSelectionChanged = [&](int number)
-            {
-                loadPresetInternal(number);
-            };
-        magicState.addTrigger("save-preset", [this]
-            {
-                savePresetInternal();
-            });
+        // Preset recall morphs over this many seconds
 
-        magicState.setApplicationSettingsFile(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
-            .getChildFile(ProjectInfo::companyName)
-            .getChildFile(ProjectInfo::projectName + juce::String(".settings")));
+        presetMorphSeconds.referTo(magicState.getPropertyAsValue("preset-morph"));
 
-        magicState.setPlayheadUpdateFrequency(30);
+        if (presetMorphSeconds.getValue().isVoid())
+            presetMorphSeconds = 0.25;
 
 }
 
 Ek0Ka0sAudioProcessor::~Ek0Ka0sAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -116,7 +102,15 @@ bool Ek0Ka0sAudioProcessor::isMidiEffect() const
 
 double Ek0Ka0sAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // From the current settings: the longer chain plus the oversampling latency
+
+    const double sampleRate = getSampleRate() > 0 ? getSampleRate() : 44100.0;
+    const auto params = parameterCache.load();
+
+    const double tailSamples = juce::jmax(computeTailSamples(params, false, sampleRate),
+                                          computeTailSamples(params, true, sampleRate));
+
+    return (tailSamples + getLatencySamples()) / sampleRate;
 }
 
 int Ek0Ka0sAudioProcessor::getNumPrograms()
@@ -147,24 +141,177 @@ void Ek0Ka0sAudioProcessor::changeProgramName (int index, const juce::String& ne
 
 void Ek0Ka0sAudioProcessor::savePresetInternal()
 {
-    presetNode = magicState.getSettings().getOrCreateChildWithName("presets", nullptr);
+    int number = presetBank->getNumPresets() + 1;
 
-    juce::ValueTree preset{ "Preset" };
-    preset.setProperty("name", "Preset " + juce::String(presetNode.getNumChildren() + 1), nullptr);
+    while (presetBank->indexOf("Preset " + juce::String(number)) >= 0)
+        ++number;
 
-    foleys::ParameterManager manager(*this);
-    manager.saveParameterValues(preset);
-
-    presetNode.appendChild(preset, nullptr);
+    presetBank->add("Preset " + juce::String(number), parameterCache.load());
 }
 
 void Ek0Ka0sAudioProcessor::loadPresetInternal(int index)
 {
-    presetNode = magicState.getSettings().getOrCreateChildWithName("presets", nullptr);
-    auto preset = presetNode.getChild(index);
+    const auto* preset = presetBank->getPreset(index);
+
+    if (preset == nullptr)
+        return;
+
+    // The audio thread morphs into the whole preset at once; the parameters follow
+    // so the host and the GUI show it, but the audio ignores them until the morph ends
+
+    presetMorph.start(preset->values, (double) presetMorphSeconds.getValue());
+
+    for (const auto& d : Ek0Ka0s::descriptors)
+        if (auto* parameter = treeState.getParameter(d.id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(preset->values[d.index]));
+}
+
+//==============================================================================
+
+void Ek0Ka0sAudioProcessor::setLfoSeed(juce::int64 seed)
+{
+    lfoSeed.setValue(seed);
+}
 
-    foleys::ParameterManager manager(*this);
-    manager.loadParameterValues(preset);
+juce::int64 Ek0Ka0sAudioProcessor::getLfoSeed() const
+{
+    return static_cast<juce::int64>(lfoSeed.getValue());
+}
+
+//==============================================================================
+// State format, little endian:
+//     int magic, int version
+//     int numParams, numParams x (string parameter ID, float value)
+//     the GUI property tree, as written by juce::ValueTree::writeToStream
+
+void Ek0Ka0sAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    const auto params = parameterCache.load();
+
+    juce::MemoryOutputStream stream(destData, false);
+
+    stream.writeInt(stateMagic);
+    stream.writeInt(stateVersion);
+    stream.writeInt(Ek0Ka0s::numParams);
+
+    for (const auto& d : Ek0Ka0s::descriptors)
+    {
+        stream.writeString(d.id);
+        stream.writeFloat(params[d.index]);
+    }
+
+    // The GUI properties, without the meters: they are readings, not state
+
+    auto properties = magicState.getPropertyRoot().createCopy();
+    properties.removeChild(properties.getChildWithName(LoadMeter::propertyNode), nullptr);
+    properties.writeToStream(stream);
+}
+
+void Ek0Ka0sAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    juce::MemoryInputStream stream(data, (size_t) sizeInBytes, false);
+
+    if (sizeInBytes < 12 || stream.readInt() != stateMagic)
+    {
+        foleys::MagicProcessor::setStateInformation(data, sizeInBytes);   // XML from older versions
+        loadMeter.setProperties(magicState);                              // it replaced the properties too
+        stateRestored = true;
+        return;
+    }
+
+    if (stream.readInt() > stateVersion)
+        return;
+
+    // Parameters by ID: ones the state doesn't know take their default, unknown IDs are skipped
+
+    Ek0Ka0s::Snapshot params;
+
+    for (const auto& d : Ek0Ka0s::descriptors)
+        params.values[(size_t) d.index] = d.defaultValue;
+
+    const int numStateParams = stream.readInt();
+
+    for (int i = 0; i < numStateParams && ! stream.isExhausted(); ++i)
+    {
+        const auto id = stream.readString();
+        const float value = stream.readFloat();
+
+        for (const auto& d : Ek0Ka0s::descriptors)
+            if (id == d.id)
+                params.values[(size_t) d.index] = value;
+    }
+
+    // The whole batch goes in before the audio thread is told; parameters that
+    // already hold their value aren't touched, so the host isn't notified for them
+
+    const auto current = parameterCache.load();
+
+    for (const auto& d : Ek0Ka0s::descriptors)
+        if (params[d.index] != current[d.index])
+            if (auto* parameter = treeState.getParameter(d.id))
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(params[d.index]));
+
+    auto properties = juce::ValueTree::readFromStream(stream);
+
+    if (properties.isValid())
+    {
+        properties.removeChild(properties.getChildWithName(LoadMeter::propertyNode), nullptr);     // states saved with readings
+        magicState.getPropertyRoot().copyPropertiesAndChildrenFrom(properties, nullptr);
+
+        loadMeter.setProperties(magicState);    // the copy replaced the meters node
+    }
+
+    stateRestored = true;
+}
+
+//==============================================================================
+
+void Ek0Ka0sAudioProcessor::createGuiObjects()
+{
+    // Once, when the first editor opens
+
+    if (guiObjectsCreated)
+        return;
+
+    guiObjectsCreated = true;
+
+    magicState.setGuiValueTree(guiDefinition->createCopy());
+
+    //MAGIC GUI STUFF======================================
+
+    midOscilloscope = magicState.createAndAddObject<foleys::MagicOscilloscope>("midOsc", 0);   // channel 0 of each tap
+    sideOscilloscope = magicState.createAndAddObject<foleys::MagicOscilloscope>("sideOsc", 0);  // push is the modulation
+
+    scopeTap.setScopes(midOscilloscope, sideOscilloscope);
+
+    //=====================================================
+
+    presetList = magicState.createAndAddObject<PresetListBox>("presets", *presetBank);
+    presetList->onSelectionChanged = [&](int number)
+        {
+            loadPresetInternal(number);
+        };
+    magicState.addTrigger("save-preset", [this]
+        {
+            savePresetInternal();
+        });
+
+    magicState.setPlayheadUpdateFrequency(30);
+}
+
+juce::AudioProcessorEditor* Ek0Ka0sAudioProcessor::createEditor()
+{
+    createGuiObjects();
+    scopeTap.setEditorOpen(true);
+    loadMeter.setEditorOpen(true);
+    return foleys::MagicProcessor::createEditor();
+}
+
+void Ek0Ka0sAudioProcessor::editorBeingDeleted(juce::AudioProcessorEditor* editor) noexcept
+{
+    scopeTap.setEditorOpen(false);
+    loadMeter.setEditorOpen(false);
+    foleys::MagicProcessor::editorBeingDeleted(editor);
 }
 
 //==============================================================================
@@ -178,43 +325,186 @@ void Ek0Ka0sAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
     spec.sampleRate = sampleRate;                    // sample rate and number of outputs to be passed to
     spec.numChannels = getTotalNumOutputChannels();  // the prepare function of other DSP modules
 
-    // Filter Modules initialization                    << Like filters here
+    // Channel pairs of the current layout -> lanes
+
+    const auto layout = getChannelLayoutOfBus(true, 0);
+
+    isMono = layout.size() == 1;
+    numPairs = isMono ? 1 : findChannelPairs(layout, pairs);
+    numLanes = isMono ? 1 : 2 * numPairs;
+
+    // Offline, the lanes' delays run on the shared pool, over tiles long enough
+    // to pay for handing them out
+
+    preparedNonRealtime = isNonRealtime();
+
+    const bool parallelLanes = preparedNonRealtime && numLanes > 1;
+
+    if (parallelLanes)
+        chainWorkers->start();
+
+    const int tileSize = juce::jlimit(1, parallelLanes ? maxOfflineTileSize : maxTileSize, samplesPerBlock);
+
+    // Channels outside the pairs only get the latency
+
+    passThroughChannels.clear();
+
+    for (int channel = isMono ? 1 : 0; channel < layout.size(); ++channel)
+        if (std::none_of(pairs.begin(), pairs.begin() + numPairs,
+                         [channel](const ChannelPair& p) { return p.left == channel || p.right == channel; }))
+            passThroughChannels.push_back(channel);
+
+    // Oversampling, reported to the host as latency, and the signal path of the
+    // host's precision
+
+    blockParams = parameterCache.load();
+    oversamplingOrder = chosenOversamplingOrder(blockParams);
+
+    const int factor = 1 << oversamplingOrder;
+
+    preparedDoublePrecision = isUsingDoublePrecision();
+
+    const int latency = preparedDoublePrecision ? preparePath(doublePath, tileSize, sampleRate, parallelLanes)
+                                                : preparePath(floatPath, tileSize, sampleRate, parallelLanes);
+
+    // Only one precision runs at a time; the other path gives its memory back
 
-    MidFilterModule.reset();
-    SideFilterModule.reset();
-    MidFilterModule.prepare(spec);                   
-    SideFilterModule.prepare(spec);
+    if (preparedDoublePrecision)
+        releasePath(floatPath);
+    else
+        releasePath(doublePath);
+
+    setLatencySamples(latency);
+
+    oversampledTimes.setSize(numLanes, tileSize * factor);
+    lastLaneTime.fill(0.f);
+    oversampledTapTimes.setSize(numLanes * (MSEngineBase::maxTaps - 1), tileSize * factor);
+    lastTapTime.fill(0.f);
 
     // LFO initialization
 
-    lfoMid.prepare(spec);
-    lfoSide.prepare(spec);
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        lfos[(size_t) lane].prepare(spec);
+        lfos[(size_t) lane].reset();
+        lfos[(size_t) lane].setSeed((uint64_t) getLfoSeed(), (uint64_t) lane);  // same seed, separate streams
 
-    // Delay Modules Initializiation                    << Delays here and so on...
+        for (int tap = 1; tap < MSEngineBase::maxTaps; ++tap)
+        {
+            const int index = MSEngineBase::tapIndex(lane, tap);
 
-    MidDelayModule.reset();
-    SideDelayModule.reset();
-    MidDelayModule.prepare(spec);
-    SideDelayModule.prepare(spec);
+            tapLfos[(size_t) index].prepare(spec);
+            tapLfos[(size_t) index].reset();
+            tapLfos[(size_t) index].setSeed((uint64_t) getLfoSeed(), (uint64_t) (maxLanes + index));
+        }
+    }
 
+    // Scratch buffers for the block pipeline, never resized on the audio thread
 
-    //SmoothedValues -> Creates linear interpolation in parameter changes.
-    
-    float rampTime = 0.02;
+    scratch.setSize(numScratchChannels, tileSize);
+    scratch.clear();
+
+    laneTimes.setSize(numLanes, tileSize);
+    tapTimes.setSize(numLanes * (MSEngineBase::maxTaps - 1), tileSize);
+    laneCutoffs.setSize(numLanes, tileSize);
+
+    laneSilentSamples.fill(0);
+    laneOutputPeak.fill(0.f);
+    laneIsActive.fill(true);
+    laneHoldsSignal.fill(false);     // the engine starts out cleared
+
+    // Scopes get roughly 1.5 kHz worth of frames, delay times scaled by the longest tap
+
+    scopeTap.prepare(juce::jmax(1, juce::roundToInt(sampleRate / 1500.0)), 1.f / (float) maxDelaySamples);
+    loadMeter.prepare(sampleRate);
+
+
+    //Smoothers -> Ramp parameter changes, linearly or multiplicatively.
+
+    const double rampTime = 0.02;
+
+    smoothers.prepare(numSmoothers, tileSize, sampleRate);
+
+    for (int i = 0; i < numSmoothers; ++i)
+        smoothers.setRamp(i, SmootherBank::Ramp::linear, rampTime);
+
+    for (auto i : { cutoffMidSmoother, cutoffSideSmoother, timeMidSmoother, timeSideSmoother,
+                    lfoSpeedMidSmoother, lfoSpeedSideSmoother })
+        smoothers.setRamp(i, SmootherBank::Ramp::multiplicative, rampTime);
+
+    oversampledRamps.setSize(numEngineRamps, tileSize * factor);
+    oversampledCutoffs.setSize(numLanes, tileSize * factor);
+
+    // Start from the current parameter values instead of ramping up from zero
+
+    stateRestored = false;
+    jumpToParameters(blockParams);
+
+}
+
+template <typename SampleType>
+int Ek0Ka0sAudioProcessor::preparePath(SignalPath<SampleType>& path, int tileSize, double sampleRate, bool parallelLanes)
+{
+    // Returns the latency. Preparing again with the same spec keeps the buffers
+    // and only clears them.
+
+    const int factor = 1 << oversamplingOrder;
+    int latency = 0;
 
-        //GUI
+    const std::array<int, 4> oversamplingSpec { numLanes, oversamplingOrder, tileSize, isNonRealtime() ? 1 : 0 };
 
-    Width_Target.reset(sampleRate, rampTime);
+    if (oversamplingOrder == 0)
+    {
+        path.oversampling.reset();
+    }
+    else if (path.oversampling == nullptr || path.oversamplingSpec != oversamplingSpec)
+    {
+        const auto filterType = isNonRealtime() ? juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple
+                                                : juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR;
+
+        path.oversampling = std::make_unique<juce::dsp::Oversampling<SampleType>>((size_t) numLanes, (size_t) oversamplingOrder, filterType, true, true);
+        path.oversampling->initProcessing((size_t) tileSize);
+    }
+    else
+    {
+        path.oversampling->reset();
+    }
 
-    Time_Mid_Target.reset(sampleRate, rampTime);
-    Time_Side_Target.reset(sampleRate, rampTime);
+    path.oversamplingSpec = oversamplingSpec;
 
-    LFO_Depth_Mid_Target.reset(sampleRate, rampTime);
-    LFO_Depth_Side_Target.reset(sampleRate, rampTime);
-    LFO_Speed_Mid_Target.reset(sampleRate, rampTime);
-    LFO_Speed_Side_Target.reset(sampleRate, rampTime);
+    if (path.oversampling != nullptr)
+        latency = juce::roundToInt(path.oversampling->getLatencyInSamples());
 
+    path.passThroughDelays.resize(latency > 0 ? passThroughChannels.size() : 0);
 
+    for (auto& delay : path.passThroughDelays)
+        delay.prepare(latency);
+
+    // Filter and Delay initialization
+
+    path.engine.setWorkers(parallelLanes && chainWorkers->getNumWorkers() > 0 ? &chainWorkers.get() : nullptr);
+    path.engine.prepare(numLanes, tileSize * factor, maxDelaySamples * factor, sampleRate * factor);
+
+    path.laneSignals.setSize(numLanes, tileSize);
+    path.delayed.setSize(1, tileSize);
+    path.silence.setSize(1, tileSize);
+    path.silence.clear();
+
+    return latency;
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::releasePath(SignalPath<SampleType>& path)
+{
+    path.engine.release();
+    path.oversampling.reset();
+
+    path.laneSignals.setSize(0, 0);
+    path.delayed.setSize(0, 0);
+    path.silence.setSize(0, 0);
+
+    path.passThroughDelays.clear();
+    path.passThroughDelays.shrink_to_fit();
 }
 
 void Ek0Ka0sAudioProcessor::releaseResources()
@@ -230,10 +520,15 @@ bool Ek0Ka0sAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Mono, stereo, or any layout made of L/R pairs (quad, 5.1, 7.1...)
+    const auto output = layouts.getMainOutputChannelSet();
+
+    if (output.isDisabled())
+        return false;
+
+    std::array<ChannelPair, maxPairs> layoutPairs;
+
+    if (output.size() != 1 && findChannelPairs(output, layoutPairs) == 0)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -247,328 +542,747 @@ bool Ek0Ka0sAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 }
 #endif
 
-void Ek0Ka0sAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+double Ek0Ka0sAudioProcessor::computeTailSamples(const Ek0Ka0s::Snapshot& params, bool side, double sampleRate)
 {
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-    double sampeleratero = getSampleRate();
+    auto value = [&](Ek0Ka0s::Param mid, Ek0Ka0s::Param sideParam) { return (double) params[side ? sideParam : mid]; };
 
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) // Clears channels from trash data
-        buffer.clear (i, 0, buffer.getNumSamples());
+    const double decay = std::log(1.0 / silenceThreshold);     // time constants down to the threshold
+
+    // Filter ringing at the lowest cutoff the LFO reaches: the SVF envelope decays as exp(-w t / 2Q)
+    // while underdamped (Q >= 0.5); below that its slower real pole decays at w (1/2Q - sqrt(1/4Q^2 - 1))
+
+    const double cutoff = juce::jmax(1.0, value(Ek0Ka0s::cutoffmid, Ek0Ka0s::cutoffside) / std::exp2(value(Ek0Ka0s::lfocutoffmid, Ek0Ka0s::lfocutoffside)));
+    const double resonance = value(Ek0Ka0s::resonancemid, Ek0Ka0s::resonanceside);
+    const double w = juce::MathConstants<double>::twoPi * cutoff;
+    const double damping = 1.0 / (2.0 * resonance);
+    const double rate = resonance >= 0.5 ? w * damping
+                                         : w * (damping - std::sqrt(damping * damping - 1.0));
+    const double filterSamples = decay / rate * sampleRate;
+
+    if (value(Ek0Ka0s::sendmid, Ek0Ka0s::sendside) <= 0.0)
+        return filterSamples;
+
+    // Delay: one echo period (the longest modulated time) per feedback pass down to the threshold
+
+    const double period = juce::jmax(1.0, value(Ek0Ka0s::timemid, Ek0Ka0s::timeside) + value(Ek0Ka0s::lfodepthmid, Ek0Ka0s::lfodepthside));
+    const double feedback = juce::jlimit(0.0, 0.999, value(Ek0Ka0s::feedbackmid, Ek0Ka0s::feedbackside));   // 1 would never decay
+    const double passes = feedback > 0.0 ? std::ceil(decay / -std::log(feedback)) : 0.0;
+
+    return filterSamples + period * (passes + 1.0);
+}
+
+int Ek0Ka0sAudioProcessor::findChannelPairs(const juce::AudioChannelSet& layout, std::array<ChannelPair, maxPairs>& pairs)
+{
+    using Type = juce::AudioChannelSet::ChannelType;
+
+    static constexpr Type pairTypes[][2] =
     {
-            
-            auto* channelDataLeft = buffer.getWritePointer(0);
-            auto* channelDataRight = buffer.getWritePointer(1);
-
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample) // Sample Processing
-            {                                           
-               
-               // Input Selection
-                                
-               Width = Width_Target.getNextValue(); // gets value from ramp
-                                                        
-               if (Input_Type == "Stereo") // Mid/Side encoding and Stereo Widening   
-               {
-                   xMidRaw = (2 - Width) * (channelDataLeft[sample] + channelDataRight[sample]);
-                   xSideRaw = Width * (channelDataLeft[sample] - channelDataRight[sample]);
-               }               
-
-               else   // Or Simply Mid/Side Mixer if input is Mid/Side
-               {
-                   xMidRaw = channelDataLeft[sample] * (2 - Width);
-                   xSideRaw = channelDataRight[sample] * (Width);
-               }
-
-               // Volume Control
-
-               xMidRaw *= 0.5;
-               xSideRaw *= 0.5;
-
-               // Filtering
-
-               const float xMidFilt = MidFilterModule.processSample(0, xMidRaw);
-               const float xSideFilt = SideFilterModule.processSample(0, xSideRaw);
-
-               //LFO Phase Calculation <- needed for LFOs
-
-               lfoValueMid = lfoMid.output(LFO_Speed_Mid_Target.getNextValue(), LFO_Depth_Mid_Target.getNextValue(), &xMidRaw);
-               lfoValueSide = lfoSide.output(LFO_Speed_Side_Target.getNextValue(), LFO_Depth_Side_Target.getNextValue(), &xSideRaw);
-
-               //Time Modulation -> Time Ramped Value added to LFOs'; lambda makes value always positive
-
-               Time_Side = [](double Time) {if (Time >= 0) { return Time; } else { return -Time; }  }(Time_Side_Target.getNextValue() + lfoValueSide);
-               Time_Mid =  [](double Time) {if (Time >= 0) { return Time; } else { return -Time; }  }(Time_Mid_Target.getNextValue() + lfoValueMid);
-
-               lfoValueMid = lfoMid.output(100, 0.5);
-
-               juce::AudioBuffer<float> time_side;
-               time_side.addSample(1, 1, Time_Side);
-
-               juce::AudioBuffer<float> time_mid;
-               time_mid.addSample(0, 0, lfoValueMid);
-
-               midOscilloscope->pushSamples(time_side);
-               sideOscilloscope->pushSamples(time_side);
-
-               //Mid Delay
-                
-               float dry = xMidFilt;                                                
-               float wet = MidDelayModule.popSample(0, Time_Mid);                   // Read a delayed sample
-               MidDelayModule.pushSample(0, xMidFilt + (wet * Feedback_Mid));       // Write a sample into buffer + feedback
-               float xMid = (dry * (Send_Mid - 1)) + (wet * Send_Mid);              // Dry + Wet signals
-
-               //Side Delay
-
-               dry = xSideFilt;
-               wet = SideDelayModule.popSample(0, Time_Side);
-               SideDelayModule.pushSample(0, xSideFilt + (wet * Feedback_Side));
-               float xSide = (dry * (Send_Side - 1)) + (wet * Send_Side);
-
-               // Output Handling
-
-               if (Output_Type == "Stereo")
-               { 
-                    
-                    newLeft = xMid + xSide;                                                                 
-                    newRight = xMid - xSide;
-
-
-                    if (Input_Type == "Stereo") // If Stereo i/o -> Volume control
-                    {
-                        float volumeScale;
-
-                        if (Width <= 1.f)
-                        {
-                            volumeScale = juce::jmap(Width, 1.0f, 0.0f, 0.0f, -6.0f);
-                        }
-                        else
-                        {
-                            volumeScale = juce::jmap(Width, 1.0f, 0.0f, 0.0f, 4.f);
-                        }
-
-                        channelDataLeft[sample] = newLeft * juce::Decibels::decibelsToGain(volumeScale);
-                        channelDataRight[sample] = newRight * juce::Decibels::decibelsToGain(volumeScale);                     
-                    }
-
-                    else
-                    {
-                    channelDataLeft[sample] = newLeft;
-                    channelDataRight[sample] = newRight;
-                    }
-                    
-               }
-               else // output == mid/side
-               {    // Channels Are Left in Mid and Right in Side                                     
-                    channelDataLeft[sample] = xMid;
-                    channelDataRight[sample] = xSide;
-               }
-            }
-     
+        { Type::left,             Type::right },
+        { Type::leftSurround,     Type::rightSurround },
+        { Type::leftSurroundSide, Type::rightSurroundSide },
+        { Type::leftSurroundRear, Type::rightSurroundRear },
+        { Type::leftCentre,       Type::rightCentre },
+        { Type::wideLeft,         Type::wideRight },
+        { Type::topFrontLeft,     Type::topFrontRight },
+        { Type::topRearLeft,      Type::topRearRight }
+    };
+
+    int numFound = 0;
+
+    for (const auto& types : pairTypes)
+    {
+        const int left = layout.getChannelIndexForType(types[0]);
+        const int right = layout.getChannelIndexForType(types[1]);
+
+        if (left >= 0 && right >= 0 && numFound < maxPairs)
+            pairs[(size_t) numFound++] = { left, right };
     }
+
+    // Discrete layouts have no speaker names: pair up neighbouring channels
+
+    if (layout.isDiscreteLayout())
+        for (int channel = 0; channel + 1 < layout.size() && numFound < maxPairs; channel += 2)
+            pairs[(size_t) numFound++] = { channel, channel + 1 };
+
+    return numFound;
 }
 
-//Function called when parameter is changed
-void Ek0Ka0sAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+namespace
 {
-    // Here we detect changes made by parameterIDs in the editor for processing in the processBlock.
+    constexpr int stereoIO = 0;   // index of "Stereo" in the input/output choices
 
-    // Width and Input Section
+    // Choice index -> DSP setting, in the order of the choice strings in Ek0Ka0s
 
-    if (parameterID == "stereowidth")
+    constexpr MSEngineBase::FilterMode filterModes[] =
+    {
+        MSEngineBase::lowpass,
+        MSEngineBase::bandpass,
+        MSEngineBase::highpass
+    };
 
-        Width_Target.setTargetValue(newValue);       
+    constexpr Osc::Waveform waveforms[] =
+    {
+        Osc::Waveform::Sine,
+        Osc::Waveform::Triangle,
+        Osc::Waveform::Sawtooth,
+        Osc::Waveform::Square,
+        Osc::Waveform::Random,
+        Osc::Waveform::SH
+    };
+}
 
-    else if (parameterID == "input")
+void Ek0Ka0sAudioProcessor::applyParameters(const Ek0Ka0s::Snapshot& params, bool force)
+{
+    // Ramped values
+
+    smoothers.setTargetValue(widthSmoother, params[Ek0Ka0s::stereowidth]);
+    smoothers.setTargetValue(cutoffMidSmoother, params[Ek0Ka0s::cutoffmid]);
+    smoothers.setTargetValue(resonanceMidSmoother, params[Ek0Ka0s::resonancemid]);
+    smoothers.setTargetValue(sendMidSmoother, params[Ek0Ka0s::sendmid]);
+    smoothers.setTargetValue(timeMidSmoother, params[Ek0Ka0s::timemid]);
+    smoothers.setTargetValue(feedbackMidSmoother, params[Ek0Ka0s::feedbackmid]);
+    smoothers.setTargetValue(lfoSpeedMidSmoother, lfoSpeed(params, false));
+    smoothers.setTargetValue(lfoDepthMidSmoother, params[Ek0Ka0s::lfodepthmid]);
+    smoothers.setTargetValue(cutoffSideSmoother, params[Ek0Ka0s::cutoffside]);
+    smoothers.setTargetValue(resonanceSideSmoother, params[Ek0Ka0s::resonanceside]);
+    smoothers.setTargetValue(sendSideSmoother, params[Ek0Ka0s::sendside]);
+    smoothers.setTargetValue(timeSideSmoother, params[Ek0Ka0s::timeside]);
+    smoothers.setTargetValue(feedbackSideSmoother, params[Ek0Ka0s::feedbackside]);
+    smoothers.setTargetValue(lfoSpeedSideSmoother, lfoSpeed(params, true));
+    smoothers.setTargetValue(lfoDepthSideSmoother, params[Ek0Ka0s::lfodepthside]);
+
+    // Derived state, only recomputed when its parameter moved
+
+    auto changed = [&](Ek0Ka0s::Param p) { return force || params[p] != appliedParams[p]; };
+
+    // Every pair shares the Mid and Side settings
+
+    auto applyChain = [&](int firstLane, Ek0Ka0s::Param waveform, Ek0Ka0s::Param taps, Ek0Ka0s::Param spread,
+                          Ek0Ka0s::Param gain, Ek0Ka0s::Param width)
     {
-        switch ((int)newValue)
+        if (changed(waveform))
         {
-        case 0:
-            Input_Type = "Stereo";
-            break;
-        case 1:
-            Input_Type = "Mid/Side";
-            break;
+            for (int lane = firstLane; lane < numLanes; lane += 2)
+            {
+                lfos[(size_t) lane].setWaveform(waveforms[params.choice(waveform)]);
+
+                for (int tap = 1; tap < MSEngineBase::maxTaps; ++tap)
+                    tapLfos[(size_t) MSEngineBase::tapIndex(lane, tap)].setWaveform(waveforms[params.choice(waveform)]);
+            }
         }
-    }
 
-    else if (parameterID == "output")
-    {
-        switch ((int)newValue)
+        const int numTaps = params.choice(taps);
+
+        if (changed(taps))
+            setTapLfoPhases(firstLane, numTaps);
+
+        if (changed(taps) || changed(gain) || changed(width) || changed(spread))
         {
-        case 0:
-            Output_Type = "Stereo";
-            break;
-        case 1:
-            Output_Type = "Mid/Side";
-            break;
+            // Every extra tap at the same gain, alternately panned right and left
+
+            float gains[MSEngineBase::maxTaps - 1], pans[MSEngineBase::maxTaps - 1];
+
+            for (int tap = 1; tap < numTaps; ++tap)
+            {
+                gains[tap - 1] = params[gain];
+                pans[tap - 1] = params[width] * (tap % 2 == 1 ? 1.f : -1.f);
+            }
+
+            withEngine([&](auto& engine)
+            {
+                for (int lane = firstLane; lane < numLanes; lane += 2)
+                    engine.setTaps(lane, numTaps, gains, pans);
+            });
         }
-    }
+    };
 
-    //Filter Section
+    applyChain(0, Ek0Ka0s::waveformmid, Ek0Ka0s::tapsmid, Ek0Ka0s::tapspreadmid, Ek0Ka0s::tapgainmid, Ek0Ka0s::tapwidthmid);
+    applyChain(1, Ek0Ka0s::waveformside, Ek0Ka0s::tapsside, Ek0Ka0s::tapspreadside, Ek0Ka0s::tapgainside, Ek0Ka0s::tapwidthside);
 
-        //Mid
+    // Tails, for the silence gates
 
-    else if (parameterID == "cutoffmid")
-    { 
-        Cut_Off_Mid = newValue;
-        MidFilterModule.setCutoffFrequency(Cut_Off_Mid);
-    }
+    chainTailSamples[0] = computeTailSamples(params, false, getSampleRate());
+    chainTailSamples[1] = computeTailSamples(params, true, getSampleRate());
+
+    appliedParams = params;
+}
+
+void Ek0Ka0sAudioProcessor::setTapLfoPhases(int firstLane, int numTaps)
+{
+    // Taps 1 .. numTaps - 1 sit at even fractions of a cycle from the lane's LFO
+
+    for (int lane = firstLane; lane < numLanes; lane += 2)
+        for (int tap = 1; tap < numTaps; ++tap)
+            tapLfos[(size_t) MSEngineBase::tapIndex(lane, tap)].setPhase(lfos[(size_t) lane].getPhase()
+                                                                     + juce::MathConstants<double>::twoPi * tap / numTaps);
+}
+
+float Ek0Ka0sAudioProcessor::lfoSpeed(const Ek0Ka0s::Snapshot& params, bool side) noexcept
+{
+    const auto speed = side ? Ek0Ka0s::lfospeedside : Ek0Ka0s::lfospeedmid;
+    const auto range = side ? Ek0Ka0s::lforangeside : Ek0Ka0s::lforangemid;
+
+    return params[speed] * (params.choice(range) == 1 ? Ek0Ka0s::chaosSpeedScale : 1.f);
+}
+
+void Ek0Ka0sAudioProcessor::applyRampedValues()
+{
+    // The values used by lanes without a ramp or modulation this tile; the engine
+    // only recomputes the static coefficients of a lane whose settings moved.
+
+    const auto midMode = filterModes[blockParams.choice(Ek0Ka0s::modemid)];
+    const auto sideMode = filterModes[blockParams.choice(Ek0Ka0s::modeside)];
 
-    else if (parameterID == "modemid")
+    withEngine([&](auto& engine)
     {
-        switch ((int)newValue) // Something happens to Input_Type
+        for (int lane = 0; lane < numLanes; lane += 2)
         {
-        case 0:
-            MidFilterModule.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-            break;
-        case 1:
-            MidFilterModule.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-            break;
-        case 2:
-            MidFilterModule.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-            break;
+            engine.setFilter(lane, smoothers.getCurrentValue(cutoffMidSmoother), smoothers.getCurrentValue(resonanceMidSmoother), midMode);
+            engine.setDelayMix(lane, smoothers.getCurrentValue(sendMidSmoother), smoothers.getCurrentValue(feedbackMidSmoother));
         }
-    }
 
-    else if (parameterID == "resonancemid")
-    {
-        MidFilterModule.setResonance(newValue);
-    }
- 
+        for (int lane = 1; lane < numLanes; lane += 2)
+        {
+            engine.setFilter(lane, smoothers.getCurrentValue(cutoffSideSmoother), smoothers.getCurrentValue(resonanceSideSmoother), sideMode);
+            engine.setDelayMix(lane, smoothers.getCurrentValue(sendSideSmoother), smoothers.getCurrentValue(feedbackSideSmoother));
+        }
+    });
+}
 
-        //Side
+void Ek0Ka0sAudioProcessor::jumpToParameters(const Ek0Ka0s::Snapshot& params)
+{
+    smoothers.setCurrentAndTargetValue(widthSmoother, params[Ek0Ka0s::stereowidth]);
+    smoothers.setCurrentAndTargetValue(cutoffMidSmoother, params[Ek0Ka0s::cutoffmid]);
+    smoothers.setCurrentAndTargetValue(resonanceMidSmoother, params[Ek0Ka0s::resonancemid]);
+    smoothers.setCurrentAndTargetValue(sendMidSmoother, params[Ek0Ka0s::sendmid]);
+    smoothers.setCurrentAndTargetValue(timeMidSmoother, params[Ek0Ka0s::timemid]);
+    smoothers.setCurrentAndTargetValue(feedbackMidSmoother, params[Ek0Ka0s::feedbackmid]);
+    smoothers.setCurrentAndTargetValue(lfoSpeedMidSmoother, lfoSpeed(params, false));
+    smoothers.setCurrentAndTargetValue(lfoDepthMidSmoother, params[Ek0Ka0s::lfodepthmid]);
+    smoothers.setCurrentAndTargetValue(cutoffSideSmoother, params[Ek0Ka0s::cutoffside]);
+    smoothers.setCurrentAndTargetValue(resonanceSideSmoother, params[Ek0Ka0s::resonanceside]);
+    smoothers.setCurrentAndTargetValue(sendSideSmoother, params[Ek0Ka0s::sendside]);
+    smoothers.setCurrentAndTargetValue(timeSideSmoother, params[Ek0Ka0s::timeside]);
+    smoothers.setCurrentAndTargetValue(feedbackSideSmoother, params[Ek0Ka0s::feedbackside]);
+    smoothers.setCurrentAndTargetValue(lfoSpeedSideSmoother, lfoSpeed(params, true));
+    smoothers.setCurrentAndTargetValue(lfoDepthSideSmoother, params[Ek0Ka0s::lfodepthside]);
+
+    applyParameters(params, true);
+    applyRampedValues();
+}
+
+// A block in the precision that wasn't prepared would run through a released
+// path: it comes out silent while the message thread re-prepares. A new
+// oversampling factor needs allocations, so it is re-prepared the same way;
+// both requests are made outside process() and its no-allocation guard.
 
-    else if (parameterID == "cutoffside")
+void Ek0Ka0sAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    if (preparedDoublePrecision)
     {
-        Cut_Off_Side = newValue;
-        SideFilterModule.setCutoffFrequency(Cut_Off_Side);
+        buffer.clear();
+        requestPrepare();
+        return;
     }
 
-    else if (parameterID == "modeside")
+    process(floatPath, buffer);
+
+    if (chosenOversamplingOrder(blockParams) != oversamplingOrder)
+        requestPrepare();
+}
+
+void Ek0Ka0sAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    if (! preparedDoublePrecision)
     {
-        switch ((int)newValue) // Something happens to Input_Type
-        {
-        case 0:
-            SideFilterModule.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-            break;
-        case 1:
-            SideFilterModule.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-            break;
-        case 2:
-            SideFilterModule.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-            break;
-        }
+        buffer.clear();
+        requestPrepare();
+        return;
     }
 
-    else if (parameterID == "resonanceside")
+    process(doublePath, buffer);
+
+    if (chosenOversamplingOrder(blockParams) != oversamplingOrder)
+        requestPrepare();
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::process(SignalPath<SampleType>& path, juce::AudioBuffer<SampleType>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+    RealtimeGuard::ScopedNoAllocation noAllocation;
+    ECHO_CHAOS_PROFILE(block);
+
+    loadMeter.beginBlock();
+
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) // Clears channels from trash data
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    auto* const* channels = buffer.getArrayOfWritePointers();
+
+    const int numSamples = buffer.getNumSamples();
+    const int tileSize = scratch.getNumSamples();
+
+    const bool measureLevels = loadMeter.isMeasuringLevels();
+
+    if (measureLevels)
+        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+            loadMeter.measure(LoadMeter::input, channels[channel], numSamples);
+
+    blockParams = parameterCache.load();
+    presetMorph.process(blockParams, appliedParams, getSampleRate(), numSamples);
+
+    if (stateRestored.exchange(false))
+        jumpToParameters(blockParams);      // a restored state starts as it was saved
+    else
+        applyParameters(blockParams, false);
+
+    // I/O kernels for this block
+
+    const bool stereoInput = blockParams.choice(Ek0Ka0s::input) == stereoIO;
+    const bool stereoOutput = blockParams.choice(Ek0Ka0s::output) == stereoIO;
+
+    path.encodeKernel = MSKernels::getEncodeKernel<SampleType>(stereoInput);
+    path.decodeKernel = MSKernels::getDecodeKernel<SampleType>(stereoInput, stereoOutput);
+
+    // Every stage runs over a whole tile before the next one starts. The LFO runs
+    // before the filter because Sample & Hold samples the unfiltered mid signal.
+
+    for (int start = 0; start < numSamples; start += tileSize)
     {
-        SideFilterModule.setResonance(newValue);
+        const int numTileSamples = juce::jmin(tileSize, numSamples - start);
+
+        rampStage(numTileSamples);
+        encodeStage(path, channels, start, numTileSamples);
+        gateStage(path, numTileSamples);
+        lfoStage(path, numTileSamples);
+        oversampledStage(path, numTileSamples);
+        measureStage(path, numTileSamples);
+
+        // The scopes follow the front pair
+
+        const int side = isMono ? -1 : sideLane(0);
+        const float* modulationChannels[] = { laneTimes.getReadPointer(midLane(0)),
+                                              side < 0 ? scratch.getReadPointer(silentChannel) : laneTimes.getReadPointer(side) };
+        const SampleType* audioChannels[] = { path.laneSignals.getReadPointer(midLane(0)),
+                                              side < 0 ? path.silence.getReadPointer(0) : path.laneSignals.getReadPointer(side) };
+
+        scopeTap.push(modulationChannels, audioChannels, numTileSamples);
+
+        decodeStage(path, channels, start, numTileSamples);
+        passThroughStage(path, channels, start, numTileSamples);
     }
 
+    if (measureLevels)
+        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+            loadMeter.measure(LoadMeter::output, channels[channel], numSamples);
 
-    //Delay Section
+    loadMeter.endBlock(numSamples);
+}
+
+void Ek0Ka0sAudioProcessor::rampStage(int numSamples)
+{
+    ECHO_CHAOS_PROFILE(ramp);
 
+    // Nothing is rendered per sample while no parameter moves
 
-        //Mid
-    else if (parameterID == "sendmid")
+    smoothers.process(numSamples);
+    applyRampedValues();
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::encodeStage(SignalPath<SampleType>& path, SampleType* const* channels, int offset, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(encode);
+
+    if (isMono) // Nothing to encode, the channel is the Mid lane
     {
-        Send_Mid = newValue;
+        juce::FloatVectorOperations::copy(path.laneSignals.getWritePointer(0), channels[0] + offset, numSamples);
+        return;
     }
-    else if (parameterID == "timemid")
-    {
-                                      
-        Time_Mid_Target.setTargetValue(newValue);
 
-    }
-    else if (parameterID == "lfospeedmid")
+    const auto* width = smoothers.getValues(widthSmoother);
+
+    for (int pair = 0; pair < numPairs; ++pair)
+        path.encodeKernel(channels[pairs[(size_t) pair].left] + offset, channels[pairs[(size_t) pair].right] + offset,
+                          path.laneSignals.getWritePointer(midLane(pair)), path.laneSignals.getWritePointer(sideLane(pair)),
+                          width, numSamples);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::gateStage(SignalPath<SampleType>& path, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(gate);
+
+    for (int lane = 0; lane < numLanes; ++lane)
     {
-        LFO_Speed_Mid_Target.setTargetValue(newValue);
+        auto* signal = path.laneSignals.getWritePointer(lane);
+        const auto range = juce::FloatVectorOperations::findMinAndMax(signal, numSamples);
+
+        bool active = true;
+
+        if (juce::jmax(-range.getStart(), range.getEnd()) > silenceThreshold)
+        {
+            laneSilentSamples[(size_t) lane] = 0;   // wakes up at once
+            laneHoldsSignal[(size_t) lane] = true;
+        }
+        else
+        {
+            laneSilentSamples[(size_t) lane] += numSamples;
+
+            // Nothing went in since the lane last idled (a null Side, for one): no tail to wait for
+
+            active = laneHoldsSignal[(size_t) lane]
+                  && (laneSilentSamples[(size_t) lane] <= (juce::int64) chainTailSamples[(size_t) (lane % 2)]
+                      || laneOutputPeak[(size_t) lane] > silenceThreshold);
+
+            laneHoldsSignal[(size_t) lane] = active;
+        }
+
+        if (! active)
+            juce::FloatVectorOperations::clear(signal, numSamples);
+
+        if (active != laneIsActive[(size_t) lane])
+        {
+            laneIsActive[(size_t) lane] = active;
+            path.engine.setLaneActive(lane, active);
+        }
     }
-    else if (parameterID == "lfodepthmid")
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::measureStage(SignalPath<SampleType>& path, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(measure);
+
+    // Every running lane's output level, so the gate never reads one left over from
+    // before the input last woke it; idle lanes output silence
+
+    for (int lane = 0; lane < numLanes; ++lane)
     {
-        LFO_Depth_Mid_Target.setTargetValue(newValue);
+        if (! laneIsActive[(size_t) lane])
+        {
+            laneOutputPeak[(size_t) lane] = 0.f;
+            continue;
+        }
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax(path.laneSignals.getReadPointer(lane), numSamples);
+        laneOutputPeak[(size_t) lane] = (float) juce::jmax(-range.getStart(), range.getEnd());
     }
 
-    else if (parameterID == "waveformmid")
+    // Chain output levels for the meters
+
+    if (loadMeter.isMeasuringLevels())
+        for (int lane = 0; lane < numLanes; ++lane)
+            loadMeter.measure(lane % 2 == 0 ? LoadMeter::mid : LoadMeter::side, path.laneSignals.getReadPointer(lane), numSamples);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::lfoStage(SignalPath<SampleType>& path, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(lfo);
+
+    // Renders the LFO of each of a chain's lanes over the tile, then routes it to the
+    // delay time (depth in samples) and to the cutoff (in octaves). Time Modulation
+    // is kept always positive.
+
+    auto render = [&](int firstLane, Smoother speedSmoother, Smoother depthSmoother, Smoother timeSmoother,
+                      Smoother cutoffSmoother, float cutoffOctaves, int numTaps, float spread)
     {
-        switch ((int)newValue)
+        // No depth and no time ramp: the delay reads at one fixed time for the whole tile
+
+        const bool isStatic = smoothers.getRamp(timeSmoother) == nullptr && smoothers.getRamp(depthSmoother) == nullptr
+                           && smoothers.getCurrentValue(depthSmoother) == 0.f;
+
+        const auto* speed = smoothers.getValues(speedSmoother);
+        const auto* depth = smoothers.getValues(depthSmoother);
+        const auto* time = smoothers.getValues(timeSmoother);
+        const auto* cutoffRamp = smoothers.getRamp(cutoffSmoother);
+        const float cutoffValue = smoothers.getCurrentValue(cutoffSmoother);
+
+        for (int lane = firstLane; lane < numLanes; lane += 2)
         {
-        case 0:
-            lfoMid.setWaveform(Osc::Waveform::Sine);
-            break;
-        case 1:
-            lfoMid.setWaveform(Osc::Waveform::Triangle);
-            break;
-        case 2:
-            lfoMid.setWaveform(Osc::Waveform::Sawtooth);
-            break;
-        case 3:
-            lfoMid.setWaveform(Osc::Waveform::Square);
-            break;
-        case 4:
-            lfoMid.setWaveform(Osc::Waveform::Random);
-            break;
-        case 5:
-            lfoMid.setWaveform(Osc::Waveform::SH);
-            break;
+            if (! laneIsActive[(size_t) lane])
+            {
+                // Keep the phases running, so the modulation picks up where it would be
+
+                const double tileSpeed = smoothers.getCurrentValue(speedSmoother);
+
+                lfos[(size_t) lane].skip(tileSpeed, numSamples);
+
+                for (int tap = 1; tap < numTaps; ++tap)
+                    tapLfos[(size_t) MSEngineBase::tapIndex(lane, tap)].skip(tileSpeed, numSamples);
+
+                continue;
+            }
+
+            auto* lfo = laneTimes.getWritePointer(lane);    // the bare waveform first, then the time
+            auto* cutoff = laneCutoffs.getWritePointer(lane);
+
+            lfos[(size_t) lane].renderBlock(lfo, speed, nullptr, path.laneSignals.getReadPointer(lane), numSamples);
+
+            laneCutoffIsModulated[(size_t) lane] = cutoffOctaves > 0.f || cutoffRamp != nullptr;
+
+            if (cutoffOctaves > 0.f)
+            {
+                for (int sample = 0; sample < numSamples; ++sample)
+                    cutoff[sample] = (cutoffRamp != nullptr ? cutoffRamp[sample] : cutoffValue) * MSEngineBase::fastExp2(lfo[sample] * cutoffOctaves);
+            }
+            else if (cutoffRamp != nullptr)
+            {
+                juce::FloatVectorOperations::copy(cutoff, cutoffRamp, numSamples);
+            }
+
+            // Extra taps: spread down from the time towards time / numTaps, on their own LFO
+
+            for (int tap = 1; tap < numTaps; ++tap)
+            {
+                auto* tapTime = tapTimes.getWritePointer(MSEngineBase::tapIndex(lane, tap));
+                const float scale = 1.f - spread * (float) tap / (float) numTaps;
+
+                tapLfos[(size_t) MSEngineBase::tapIndex(lane, tap)].renderBlock(tapTime, speed, nullptr, path.laneSignals.getReadPointer(lane), numSamples);
+
+                for (int sample = 0; sample < numSamples; ++sample)
+                    tapTime[sample] = std::abs(time[sample] * scale + tapTime[sample] * depth[sample]);
+            }
+
+            for (int sample = 0; sample < numSamples; ++sample)
+                lfo[sample] = std::abs(time[sample] + lfo[sample] * depth[sample]);
+
+            laneTimeIsStatic[(size_t) lane] = isStatic;
         }
-    }
+    };
+
+    render(0, lfoSpeedMidSmoother, lfoDepthMidSmoother, timeMidSmoother, cutoffMidSmoother, blockParams[Ek0Ka0s::lfocutoffmid],
+           blockParams.choice(Ek0Ka0s::tapsmid), blockParams[Ek0Ka0s::tapspreadmid]);
 
-    else if (parameterID == "feedbackmid")
+    if (! isMono)   // a mono bus has no Side lanes
+        render(1, lfoSpeedSideSmoother, lfoDepthSideSmoother, timeSideSmoother, cutoffSideSmoother, blockParams[Ek0Ka0s::lfocutoffside],
+               blockParams.choice(Ek0Ka0s::tapsside), blockParams[Ek0Ka0s::tapspreadside]);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::oversampledStage(SignalPath<SampleType>& path, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(oversampling);
+
+    const float* ramps[numEngineRamps] = { smoothers.getRamp(sendMidSmoother), smoothers.getRamp(sendSideSmoother),
+                                           smoothers.getRamp(feedbackMidSmoother), smoothers.getRamp(feedbackSideSmoother),
+                                           smoothers.getRamp(resonanceMidSmoother), smoothers.getRamp(resonanceSideSmoother) };
+    const float* cutoffs[maxLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        cutoffs[lane] = laneCutoffIsModulated[(size_t) lane] ? laneCutoffs.getReadPointer(lane) : nullptr;
+
+    if (path.oversampling == nullptr)
     {
-        Feedback_Mid = newValue;
+        filterStage(path, path.laneSignals.getArrayOfWritePointers(), cutoffs, ramps, numSamples);
+        delayStage(path, path.laneSignals.getArrayOfWritePointers(), laneTimes.getArrayOfReadPointers(), tapTimes.getArrayOfReadPointers(), ramps, numSamples);
+        return;
     }
-        //Side
-    else if (parameterID == "sendside")
+
+    const int factor = 1 << oversamplingOrder;
+    const int numOversampled = numSamples * factor;
+
+    juce::dsp::AudioBlock<SampleType> block(path.laneSignals.getArrayOfWritePointers(), (size_t) numLanes, (size_t) numSamples);
+    auto oversampledBlock = path.oversampling->processSamplesUp(block);
+
+    SampleType* lanes[maxLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        lanes[lane] = oversampledBlock.getChannelPointer((size_t) lane);
+
+    // Delay times are in samples: scale them to the new rate and interpolate them
+    // linearly up from the LFO's rate. Static lanes only need their first value.
+
+    auto upsampleTime = [&](const float* time, float* oversampledTime, float& last, bool isStatic)
     {
-        Send_Side = newValue;
-    }
-    else if (parameterID == "timeside")
+        if (isStatic)
+        {
+            oversampledTime[0] = time[0] * (float) factor;
+        }
+        else
+        {
+            float previous = last;
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                const float step = (time[sample] - previous) / (float) factor;
+
+                for (int k = 0; k < factor; ++k)
+                    oversampledTime[sample * factor + k] = (previous + step * (float) (k + 1)) * (float) factor;
+
+                previous = time[sample];
+            }
+        }
+
+        last = time[numSamples - 1];
+    };
+
+    for (int lane = 0; lane < numLanes; ++lane)
     {
-        Time_Side_Target.setTargetValue(newValue);
+        upsampleTime(laneTimes.getReadPointer(lane), oversampledTimes.getWritePointer(lane),
+                     lastLaneTime[(size_t) lane], laneTimeIsStatic[(size_t) lane]);
+
+        const int numTaps = blockParams.choice(lane % 2 == 0 ? Ek0Ka0s::tapsmid : Ek0Ka0s::tapsside);
 
+        for (int tap = 1; tap < numTaps; ++tap)
+        {
+            const int index = MSEngineBase::tapIndex(lane, tap);
+
+            upsampleTime(tapTimes.getReadPointer(index), oversampledTapTimes.getWritePointer(index),
+                         lastTapTime[(size_t) index], laneTimeIsStatic[(size_t) lane]);
+        }
     }
-    else if (parameterID == "lfospeedside")
+
+    // Ramps and cutoffs are smooth enough to hold each value for factor samples
+
+    auto hold = [&](const float* source, float* dest)
     {
-        LFO_Speed_Side_Target.setTargetValue(newValue);
-    }
-    else if (parameterID == "lfodepthside")
+        for (int sample = 0; sample < numSamples; ++sample)
+            juce::FloatVectorOperations::fill(dest + sample * factor, source[sample], factor);
+
+        return dest;
+    };
+
+    for (int i = 0; i < numEngineRamps; ++i)
+        if (ramps[i] != nullptr)
+            ramps[i] = hold(ramps[i], oversampledRamps.getWritePointer(i));
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        if (cutoffs[lane] != nullptr)
+            cutoffs[lane] = hold(cutoffs[lane], oversampledCutoffs.getWritePointer(lane));
+
+    filterStage(path, lanes, cutoffs, ramps, numOversampled);
+    delayStage(path, lanes, oversampledTimes.getArrayOfReadPointers(), oversampledTapTimes.getArrayOfReadPointers(), ramps, numOversampled);
+
+    path.oversampling->processSamplesDown(block);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::filterStage(SignalPath<SampleType>& path, SampleType* const* lanes, const float* const* cutoffs,
+                                        const float* const* ramps, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(filter);
+
+    const float* resonances[maxLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        resonances[lane] = ramps[resonanceMidRamp + lane % 2];
+
+    path.engine.filterStage(lanes, cutoffs, resonances, numSamples);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::delayStage(SignalPath<SampleType>& path, SampleType* const* lanes, const float* const* times,
+                                       const float* const* tapDelayTimes, const float* const* ramps, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(delay);
+
+    // ramps: EngineRamp order, null when not moving
+
+    const float* sendRamps[maxLanes];
+    const float* feedbackRamps[maxLanes];
+
+    for (int lane = 0; lane < numLanes; ++lane)
     {
-        LFO_Depth_Side_Target.setTargetValue(newValue);
+        sendRamps[lane] = ramps[sendMidRamp + lane % 2];
+        feedbackRamps[lane] = ramps[feedbackMidRamp + lane % 2];
     }
 
-    else if (parameterID == "waveformside")
+    path.engine.delayStage(lanes, times, laneTimeIsStatic.data(), tapDelayTimes, sendRamps, feedbackRamps, numSamples);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::decodeStage(SignalPath<SampleType>& path, SampleType* const* channels, int offset, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(decode);
+
+    if (isMono)
     {
-        switch ((int)newValue)
-        {
-        case 0:
-            lfoSide.setWaveform(Osc::Waveform::Sine);
-            break;
-        case 1:
-            lfoSide.setWaveform(Osc::Waveform::Triangle);
-            break;
-        case 2:
-            lfoSide.setWaveform(Osc::Waveform::Sawtooth);
-            break;
-        case 3:
-            lfoSide.setWaveform(Osc::Waveform::Square);
-            break;
-        case 4:
-            lfoSide.setWaveform(Osc::Waveform::Random);
-            break;
-        case 5:
-            lfoSide.setWaveform(Osc::Waveform::SH);
-            break;
-        }
+        juce::FloatVectorOperations::copy(channels[0] + offset, path.laneSignals.getReadPointer(0), numSamples);
+        return;
     }
 
-    else if (parameterID == "feedbackside")
+    // Volume control for Stereo i/o, computed once for every pair
+
+    auto* gain = scratch.getWritePointer(gainChannel);
+
+    if (blockParams.choice(Ek0Ka0s::input) == stereoIO && blockParams.choice(Ek0Ka0s::output) == stereoIO)
+        MSKernels::fillWidthGain(gain, smoothers.getValues(widthSmoother), smoothers.getRamp(widthSmoother) != nullptr, numSamples);
+
+    for (int pair = 0; pair < numPairs; ++pair)
+        path.decodeKernel(path.laneSignals.getReadPointer(midLane(pair)), path.laneSignals.getReadPointer(sideLane(pair)),
+                          channels[pairs[(size_t) pair].left] + offset, channels[pairs[(size_t) pair].right] + offset,
+                          gain, numSamples);
+}
+
+template <typename SampleType>
+void Ek0Ka0sAudioProcessor::passThroughStage(SignalPath<SampleType>& path, SampleType* const* channels, int offset, int numSamples)
+{
+    ECHO_CHAOS_PROFILE(passThrough);
+
+    auto* delayed = path.delayed.getWritePointer(0);
+
+    for (size_t i = 0; i < path.passThroughDelays.size(); ++i)
     {
-        Feedback_Side = newValue;
+        auto* channel = channels[passThroughChannels[i]] + offset;
+
+        path.passThroughDelays[i].process(channel, delayed, nullptr, (float) getLatencySamples(), 0.f, numSamples);
+        juce::FloatVectorOperations::copy(channel, delayed, numSamples);
     }
 }
 
+//==============================================================================
+
+int Ek0Ka0sAudioProcessor::chosenOversamplingOrder(const Ek0Ka0s::Snapshot& params) const noexcept
+{
+    // Choice index is the log2 of the factor; offline rendering never goes below realtime
+
+    const int realtimeOrder = params.choice(Ek0Ka0s::oversampling);
+
+    return isNonRealtime() ? juce::jmax(realtimeOrder, params.choice(Ek0Ka0s::offlineoversampling))
+                           : realtimeOrder;
+}
+
+void Ek0Ka0sAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    foleys::MagicProcessor::setNonRealtime(isNonRealtime);
+
+    // Hosts usually re-prepare after switching; if this one doesn't, do it ourselves
+
+    if (getSampleRate() > 0 && needsPreparing())
+        requestPrepare();
+}
+
+void Ek0Ka0sAudioProcessor::requestPrepare() noexcept
+{
+    // Posts once until handleAsyncUpdate runs, not on every block that asks
+
+    if (! prepareRequested.exchange(true))
+        triggerAsyncUpdate();
+}
+
+bool Ek0Ka0sAudioProcessor::needsPreparing() const noexcept
+{
+    return chosenOversamplingOrder(parameterCache.load()) != oversamplingOrder || isNonRealtime() != preparedNonRealtime
+        || isUsingDoublePrecision() != preparedDoublePrecision;
+}
+
+void Ek0Ka0sAudioProcessor::handleAsyncUpdate()
+{
+    prepareRequested = false;       // a change made from here on asks again
+
+    if (getSampleRate() <= 0 || ! needsPreparing())
+        return;
+
+    suspendProcessing(true);
+    prepareToPlay(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
+}
 
 //==============================================================================
 // This creates new instances of the plugin..
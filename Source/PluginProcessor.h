@@ -11,6 +11,13 @@
 #include <JuceHeader.h>
 #include "Ek0Ka0s.h"
 #include "Osc.h"
+#include "ScopeTap.h"
+#include "MSEngine.h"
+#include "SmootherBank.h"
+#include "MSKernels.h"
+#include "PresetBank.h"
+#include "LoadMeter.h"
+#include "GuiDefinition.h"
 
 //==============================================================================
 /**
@@ -21,7 +28,7 @@ class PresetListBox;
 //==============================================================================
 
 class Ek0Ka0sAudioProcessor  : public foleys::MagicProcessor,
-                               public juce::AudioProcessorValueTreeState::Listener
+                               private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -37,6 +44,15 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    void editorBeingDeleted (juce::AudioProcessorEditor* editor) noexcept override;
 
     //==============================================================================
     const juce::String getName() const override;
@@ -54,82 +70,276 @@ public:
     void changeProgramName (int index, const juce::String& newName) override;
 
     //==============================================================================
+    // Plugin state is a compact binary blob: the parameter values by ID, then the
+    // GUI properties (seed, preset morph time...). XML states from older versions
+    // still load. A restore is applied as one batch: the parameters are all set
+    // first and the DSP jumps to them once, at the start of the next block.
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    static constexpr int stateMagic = 0x54534345;   // "ECST"
+    static constexpr int stateVersion = 1;
+
+    //==============================================================================
+    // Presets live in the shared binary PresetBank; recalling one morphs into it
+    // over the "preset-morph" time (seconds) instead of jumping.
     void savePresetInternal();
     void loadPresetInternal(int index);
 
     //==============================================================================
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    // Seed of the Random / Sample & Hold generators. It is saved with the plugin
+    // state and applied in prepareToPlay, so offline bounces are reproducible.
+    void setLfoSeed(juce::int64 seed);
+    juce::int64 getLfoSeed() const;
 
 private:
 
-    juce::AudioProcessorValueTreeState treeState;
-    juce::ValueTree                    presetNode;
+    //==============================================================================
+    // Signal path. What carries audio is templated on the sample type: float hosts
+    // run SignalPath<float>, double precision hosts SignalPath<double>, each with
+    // no conversions. Only the path of the current precision is prepared; the
+    // modulation (delay times, cutoffs, ramps, LFOs) is float for both.
+
+    template <typename SampleType>
+    struct SignalPath
+    {
+        MSEngine<SampleType> engine;
+        std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+        std::array<int, 4> oversamplingSpec {};         // lanes, order, tile size, offline filters
+
+        juce::AudioBuffer<SampleType> laneSignals;      // Mid/Side signal of every lane
+        juce::AudioBuffer<SampleType> delayed;          // one pass-through channel, delayed
+        juce::AudioBuffer<SampleType> silence;          // the Side scope of a mono bus
+
+        std::vector<EchoDelay<SampleType, EchoDelayInterpolation::None>> passThroughDelays;
+
+        // Encode/decode for this block's Input and Output types
+
+        MSKernels::EncodeKernel<SampleType> encodeKernel = MSKernels::getEncodeKernel<SampleType>(true);
+        MSKernels::DecodeKernel<SampleType> decodeKernel = MSKernels::getDecodeKernel<SampleType>(true, true);
+    };
+
+    SignalPath<float> floatPath;
+    SignalPath<double> doublePath;
+    bool preparedDoublePrecision = false;
+
+    // Calls function with the engine of the prepared path
+    template <typename Function>
+    void withEngine (Function&& function)
+    {
+        if (preparedDoublePrecision)
+            function(doublePath.engine);
+        else
+            function(floatPath.engine);
+    }
+
+    //==============================================================================
+    // Block pipeline. processBlock splits the host buffer into tiles of at most
+    // maxTileSize samples and runs every stage over a whole tile before moving on.
+
+    static constexpr int maxTileSize = 256;
+    static constexpr int maxOfflineTileSize = 4096;     // offline with the lanes on ChainWorkers
+
+    template <typename SampleType> int preparePath (SignalPath<SampleType>& path, int tileSize, double sampleRate, bool parallelLanes);
+    template <typename SampleType> void releasePath (SignalPath<SampleType>& path);
+    template <typename SampleType> void process (SignalPath<SampleType>& path, juce::AudioBuffer<SampleType>& buffer);
+
+    void rampStage (int numSamples);
+
+    template <typename SampleType> void encodeStage      (SignalPath<SampleType>& path, SampleType* const* channels, int offset, int numSamples);
+    template <typename SampleType> void gateStage        (SignalPath<SampleType>& path, int numSamples);
+    template <typename SampleType> void lfoStage         (SignalPath<SampleType>& path, int numSamples);
+    template <typename SampleType> void oversampledStage (SignalPath<SampleType>& path, int numSamples);     // filterStage + delayStage at the oversampled rate
+    template <typename SampleType> void measureStage     (SignalPath<SampleType>& path, int numSamples);
+    template <typename SampleType> void filterStage      (SignalPath<SampleType>& path, SampleType* const* lanes, const float* const* cutoffs,
+                                                          const float* const* ramps, int numSamples);
+    template <typename SampleType> void delayStage       (SignalPath<SampleType>& path, SampleType* const* lanes, const float* const* times,
+                                                          const float* const* tapDelayTimes, const float* const* ramps, int numSamples);
+    template <typename SampleType> void decodeStage      (SignalPath<SampleType>& path, SampleType* const* channels, int offset, int numSamples);
+    template <typename SampleType> void passThroughStage (SignalPath<SampleType>& path, SampleType* const* channels, int offset, int numSamples);
+
+    // Scratch channels shared by every pair, allocated once in prepareToPlay
+
+    enum ScratchChannel
+    {
+        gainChannel = 0,
+        silentChannel,
+        numScratchChannels
+    };
+
+    juce::AudioBuffer<float> scratch;
+
+    //==============================================================================
+    // Channel pairs. Every L/R pair of the bus (front, surround, rear...) is encoded
+    // into its own Mid and Side lane, and all lanes run through the engine together.
+    // Channels without a partner (centre, LFE) pass through. A mono bus only has the
+    // Mid lane; the Side path is skipped entirely.
+
+    static constexpr int maxPairs = 8;
+    static constexpr int maxLanes = 2 * maxPairs;
+
+    struct ChannelPair { int left = 0, right = 1; };
+
+    static int findChannelPairs (const juce::AudioChannelSet& layout, std::array<ChannelPair, maxPairs>& pairs);
+
+    static int midLane  (int pair) noexcept { return 2 * pair; }
+    static int sideLane (int pair) noexcept { return 2 * pair + 1; }
 
+    std::array<ChannelPair, maxPairs> pairs;
+    int numPairs = 1;
+    int numLanes = 2;
+    bool isMono = false;
 
-    // Initialization of Variables for parameterChanged (ultimately for processing block)
+    juce::AudioBuffer<float> laneTimes;                 // delay time of every lane
+    juce::AudioBuffer<float> laneCutoffs;               // cutoff of every lane, when it moves
+    std::array<bool, maxLanes> laneCutoffIsModulated {};
+    std::array<bool, maxLanes> laneTimeIsStatic {};     // set by lfoStage when the tile's delay time doesn't move
 
-    // Width
+    static constexpr int maxTapTimes = maxLanes * (MSEngineBase::maxTaps - 1);
 
-    float Width;
-    juce::SmoothedValue<float> Width_Target;
+    juce::AudioBuffer<float> tapTimes;                  // delay time of every extra tap, at MSEngineBase::tapIndex
 
-    // Input/Outputs and other variables that need to be global for the logic to work
+    //==============================================================================
+    // Tail and silence. A lane whose input stays below silenceThreshold for longer
+    // than its chain's tail, and whose output has died down too, is skipped by the
+    // LFO, filter and delay stages until its input comes back; the tile it comes
+    // back in is processed in full. A lane that has held no signal since it last
+    // idled has nothing to ring out and idles at once: mono material on a stereo
+    // pair (L = R, so a null Side) keeps the Side chain idle from its first tile.
+    // Idle lanes still advance their LFO phases.
+
+    static constexpr float silenceThreshold = 1.0e-5f;  // -100 dB
+
+    static double computeTailSamples (const Ek0Ka0s::Snapshot& params, bool side, double sampleRate);
+
+    std::array<double, 2> chainTailSamples {};          // Mid, Side
+    std::array<juce::int64, maxLanes> laneSilentSamples {};
+    std::array<float, maxLanes> laneOutputPeak {};
+    std::array<bool, maxLanes> laneIsActive {};
+    std::array<bool, maxLanes> laneHoldsSignal {};      // input above the threshold since the lane last idled
+
+    //==============================================================================
+    // Oversampling around the filter and delay stages, where feedback and fast time
+    // modulation alias. Realtime uses the low latency polyphase IIR filters, offline
+    // rendering the linear phase FIR ones. The factor is picked in prepareToPlay;
+    // when it changes while playing, the processor is re-prepared from the message
+    // thread. Channels outside the pairs are delayed by the same latency.
+
+    int chosenOversamplingOrder (const Ek0Ka0s::Snapshot& params) const noexcept;     // log2 of the factor
+    bool needsPreparing() const noexcept;       // the factor, realtime mode or precision changed since prepareToPlay
+    void requestPrepare() noexcept;             // any thread; at most one pending update
+    void handleAsyncUpdate() override;
+
+    int oversamplingOrder = 0;
+    bool preparedNonRealtime = false;
+    std::atomic<bool> prepareRequested { false };
+
+    juce::AudioBuffer<float> oversampledTimes;          // laneTimes at the oversampled rate
+    std::array<float, maxLanes> lastLaneTime {};        // for interpolating them across tiles
+    juce::AudioBuffer<float> oversampledTapTimes;       // the same for tapTimes
+    std::array<float, maxTapTimes> lastTapTime {};
+
+    std::vector<int> passThroughChannels;
+
+    //==============================================================================
+    // Parameters reach the DSP as one Snapshot per block, read from the cached
+    // raw parameter values. applyParameters pushes it into the DSP modules.
 
-    std::string Input_Type = "Stereo";
-    std::string Output_Type = "Stereo";
+    void applyParameters (const Ek0Ka0s::Snapshot& params, bool force);
+    void applyRampedValues();
+    void jumpToParameters (const Ek0Ka0s::Snapshot& params);     // no ramps, every derived value recomputed
 
-    float xMidRaw;
-    float xSideRaw;
+    Ek0Ka0s::ParameterCache parameterCache;
+    Ek0Ka0s::Snapshot blockParams;      // this block's values
+    Ek0Ka0s::Snapshot appliedParams;    // what the filters and LFOs were last set to
 
-    float newLeft = 0;
-    float newRight = 0;
+    std::atomic<bool> stateRestored { false };     // set by setStateInformation, consumed by processBlock
 
+    //==============================================================================
+
+    juce::AudioProcessorValueTreeState treeState;
+
+
+    // Ramped parameters, all in one bank. Cutoff, time and speed ramp multiplicatively.
+    // Width, time, speed and depth are read per sample; send, feedback, cutoff and
+    // resonance ramps go to the engine, which follows them per sample.
+
+    enum Smoother
+    {
+        widthSmoother = 0,
+        cutoffMidSmoother,
+        resonanceMidSmoother,
+        sendMidSmoother,
+        timeMidSmoother,
+        feedbackMidSmoother,
+        lfoSpeedMidSmoother,
+        lfoDepthMidSmoother,
+        cutoffSideSmoother,
+        resonanceSideSmoother,
+        sendSideSmoother,
+        timeSideSmoother,
+        feedbackSideSmoother,
+        lfoSpeedSideSmoother,
+        lfoDepthSideSmoother,
+        numSmoothers
+    };
 
-    // Initialize Filters
+    SmootherBank smoothers;
 
-    juce::dsp::StateVariableTPTFilter<float> MidFilterModule; 
-    juce::dsp::StateVariableTPTFilter<float> SideFilterModule;
+    enum EngineRamp { sendMidRamp = 0, sendSideRamp, feedbackMidRamp, feedbackSideRamp, resonanceMidRamp, resonanceSideRamp, numEngineRamps };
 
-    float Cut_Off_Mid;
-    float Cut_Off_Side;
+    juce::AudioBuffer<float> oversampledRamps;          // engine ramps at the oversampled rate
+    juce::AudioBuffer<float> oversampledCutoffs;        // laneCutoffs at the oversampled rate
 
-    // Initialize Delay Lagrange3rd is a high-quality interpolation <-> 3000 is longest num. of samples of delay tap
+    // Filters and Delays of every lane, in the signal path's engine. Delays use Lagrange3rd interpolation <->
+    // maxDelaySamples is the longest delay tap (TimeMid/Side plus LFO depth, both in samples).
 
-    juce::dsp::DelayLine<double, juce::dsp::DelayLineInterpolationTypes::Lagrange3rd> MidDelayModule{30000};
-    juce::dsp::DelayLine<double, juce::dsp::DelayLineInterpolationTypes::Lagrange3rd> SideDelayModule{30000};
+    static constexpr int maxDelaySamples = (int) (Ek0Ka0s::descriptors[Ek0Ka0s::timemid].maxValue
+                                                + Ek0Ka0s::descriptors[Ek0Ka0s::lfodepthmid].maxValue);
 
-    double Send_Mid = 0.f;
-    juce::SmoothedValue<double> Time_Mid_Target = 0.f;
-    double Time_Mid = 0.f;
-    double Feedback_Mid = 0.f;
+    static_assert(Ek0Ka0s::descriptors[Ek0Ka0s::timeside].maxValue + Ek0Ka0s::descriptors[Ek0Ka0s::lfodepthside].maxValue
+                  <= (float) maxDelaySamples, "Side delay taps must fit the same delay lines");
 
-    double Send_Side = 0.f;
-    juce::SmoothedValue<double> Time_Side_Target = 0.f;
-    double Time_Side = 0.f;
-    double Feedback_Side = 0.f;
+    // Offline renders spread the lanes of every instance over one shared pool
+
+    juce::SharedResourcePointer<ChainWorkers> chainWorkers;
 
     //LFO Variables
 
-    Osc lfoMid;
-    Osc lfoSide;
+    std::array<Osc, maxLanes> lfos;     // one per lane, driven by its chain's parameters
+
+    // Extra taps wobble on their own LFO, at the lane's speed and depth but spread
+    // evenly in phase from it, which is what makes them a chorus rather than copies
+    std::array<Osc, maxTapTimes> tapLfos;
+
+    void setTapLfoPhases(int firstLane, int numTaps);
 
-    double lfoValueMid = 0;
-    double lfoValueSide = 0;
+    // Speed dial in Hz, scaled into the audio range when the chain is set to CHAOS
+    static float lfoSpeed(const Ek0Ka0s::Snapshot& params, bool side) noexcept;
 
-    juce::SmoothedValue<double> LFO_Speed_Mid_Target = 0;
-    juce::SmoothedValue<double> LFO_Depth_Mid_Target = 0;
+    juce::Value lfoSeed;
 
-    juce::SmoothedValue<double> LFO_Speed_Side_Target = 0;
-    juce::SmoothedValue<double> LFO_Depth_Side_Target = 0;
 
+    // GUI MAGIC: the layout is shared by every instance; the objects below are
+    // only created when this instance first opens an editor
 
-    // GUI MAGIC
+    juce::SharedResourcePointer<GuiDefinition> guiDefinition;
+    bool guiObjectsCreated = false;
+
+    void createGuiObjects();
 
     PresetListBox* presetList = nullptr;
 
+    juce::SharedResourcePointer<PresetBank> presetBank;
+    PresetMorph presetMorph;
+    juce::Value presetMorphSeconds;
+
     foleys::MagicOscilloscope* midOscilloscope = nullptr;
     foleys::MagicOscilloscope* sideOscilloscope = nullptr;
 
+    ScopeTap scopeTap;
+    LoadMeter loadMeter;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Ek0Ka0sAudioProcessor)
 };
@@ -0,0 +1,342 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+// Reads the bank file off the message thread, then hands the presets back to it
+
+class PresetBank::Loader : public juce::Thread
+{
+public:
+    Loader(PresetBank& bank, juce::File fileToRead)
+        : juce::Thread("ECHO-CHAOS presets"), owner(&bank), file(std::move(fileToRead))
+    {
+        startThread();
+    }
+
+    ~Loader() override
+    {
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        std::vector<Preset> loadedPresets;
+        const bool fileExisted = file.existsAsFile();
+
+        if (fileExisted)
+        {
+            juce::FileInputStream stream(file);
+
+            if (! stream.openedOk() || ! PresetBank::read(stream, loadedPresets))
+                loadedPresets.clear();
+        }
+
+        if (threadShouldExit())
+            return;
+
+        juce::MessageManager::callAsync([bank = owner, presets = std::move(loadedPresets), fileExisted]() mutable
+        {
+            if (bank != nullptr)
+                bank->loadFinished(std::move(presets), fileExisted);
+        });
+    }
+
+private:
+    juce::WeakReference<PresetBank> owner;
+    juce::File file;
+};
+
+//==============================================================================
+
+PresetBank::PresetBank()
+    : file(getDefaultFile())
+{
+    loader = std::make_unique<Loader>(*this, file);
+}
+
+PresetBank::~PresetBank()
+{
+    loader.reset();
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName + juce::String(" Presets.bin"));
+}
+
+void PresetBank::loadFinished(std::vector<Preset> loadedPresets, bool fileExisted)
+{
+    presets = std::move(loadedPresets);
+    loaded = true;
+    rebuildIndex();
+
+    if (! fileExisted)
+        importLegacyPresets();
+
+    // Presets saved while the file was still loading go on top of it
+
+    if (! addedBeforeLoad.empty())
+    {
+        for (auto& preset : addedBeforeLoad)
+        {
+            const int existing = indexOf(preset.name);
+
+            if (existing >= 0)
+                presets[(size_t) existing].values = preset.values;
+            else
+                presets.push_back(std::move(preset));
+
+            rebuildIndex();
+        }
+
+        addedBeforeLoad.clear();
+        save();
+    }
+
+    sendChangeMessage();
+}
+
+void PresetBank::importLegacyPresets()
+{
+    // Older versions saved presets through foleys::ParameterManager: one child per
+    // parameter with "id" and "value" properties
+
+    foleys::SharedApplicationSettings settings;
+    auto legacy = settings->settings.getChildWithName("presets");
+
+    if (legacy.getNumChildren() == 0)
+        return;
+
+    for (int i = 0; i < legacy.getNumChildren(); ++i)
+    {
+        const auto node = legacy.getChild(i);
+        Preset preset { node.getProperty("name").toString(), {} };
+
+        for (const auto& d : Ek0Ka0s::descriptors)
+        {
+            const auto parameter = node.getChildWithProperty("id", d.id);
+            preset.values.values[(size_t) d.index] = parameter.isValid() ? (float) parameter.getProperty("value") : d.defaultValue;
+        }
+
+        presets.push_back(std::move(preset));
+    }
+
+    rebuildIndex();
+    save();
+}
+
+//==============================================================================
+
+const PresetBank::Preset* PresetBank::getPreset(int i) const noexcept
+{
+    return juce::isPositiveAndBelow(i, getNumPresets()) ? &presets[(size_t) i] : nullptr;
+}
+
+int PresetBank::indexOf(const juce::String& name) const
+{
+    return index.contains(name) ? index[name] : -1;
+}
+
+void PresetBank::add(const juce::String& name, const Ek0Ka0s::Snapshot& values)
+{
+    const int existing = indexOf(name);
+
+    if (existing >= 0)
+        presets[(size_t) existing].values = values;
+    else
+        presets.push_back({ name, values });
+
+    rebuildIndex();
+
+    // Saving now would overwrite the file before its presets are in
+
+    if (loaded)
+        save();
+    else
+        addedBeforeLoad.push_back({ name, values });
+
+    sendChangeMessage();
+}
+
+void PresetBank::remove(int i)
+{
+    if (! juce::isPositiveAndBelow(i, getNumPresets()))
+        return;
+
+    const auto name = presets[(size_t) i].name;
+    presets.erase(presets.begin() + i);
+
+    rebuildIndex();
+
+    if (loaded)
+        save();
+    else
+        addedBeforeLoad.erase(std::remove_if(addedBeforeLoad.begin(), addedBeforeLoad.end(),
+                                             [&](const Preset& p) { return p.name == name; }),
+                              addedBeforeLoad.end());
+
+    sendChangeMessage();
+}
+
+void PresetBank::rebuildIndex()
+{
+    index.clear();
+
+    for (int i = 0; i < getNumPresets(); ++i)
+        index.set(presets[(size_t) i].name, i);
+}
+
+bool PresetBank::save() const
+{
+    // Written next to the old file and swapped in, so a failed write never loses the bank
+
+    file.getParentDirectory().createDirectory();
+
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream stream(temp.getFile());
+
+        if (! stream.openedOk() || ! write(stream, presets))
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+// Format, little endian:
+//     int magic, int version
+//     int numParams, numParams x string parameter ID
+//     int numPresets, numPresets x (string name, numParams x float value)
+
+bool PresetBank::write(juce::OutputStream& stream, const std::vector<Preset>& presets)
+{
+    bool ok = stream.writeInt(magic) && stream.writeInt(version) && stream.writeInt(Ek0Ka0s::numParams);
+
+    for (const auto& d : Ek0Ka0s::descriptors)
+        ok = ok && stream.writeString(d.id);
+
+    ok = ok && stream.writeInt((int) presets.size());
+
+    for (const auto& preset : presets)
+    {
+        ok = ok && stream.writeString(preset.name);
+
+        for (auto value : preset.values.values)
+            ok = ok && stream.writeFloat(value);
+    }
+
+    return ok;
+}
+
+bool PresetBank::read(juce::InputStream& stream, std::vector<Preset>& presets)
+{
+    if (stream.readInt() != magic || stream.readInt() > version)
+        return false;
+
+    // Map the file's parameters onto ours by ID; -1 for ones that no longer exist
+
+    const int numFileParams = stream.readInt();
+
+    if (numFileParams < 0 || numFileParams > 4096)
+        return false;
+
+    std::vector<int> mapping((size_t) numFileParams, -1);
+
+    for (auto& target : mapping)
+    {
+        const auto id = stream.readString();
+
+        for (const auto& d : Ek0Ka0s::descriptors)
+            if (id == d.id)
+                target = d.index;
+    }
+
+    const int numPresets = stream.readInt();
+
+    if (numPresets < 0)
+        return false;
+
+    presets.clear();
+    presets.reserve((size_t) numPresets);
+
+    for (int i = 0; i < numPresets && ! stream.isExhausted(); ++i)
+    {
+        Preset preset { stream.readString(), {} };
+
+        for (const auto& d : Ek0Ka0s::descriptors)
+            preset.values.values[(size_t) d.index] = d.defaultValue;
+
+        for (auto target : mapping)
+        {
+            const float value = stream.readFloat();
+
+            if (target >= 0)
+                preset.values.values[(size_t) target] = value;
+        }
+
+        presets.push_back(std::move(preset));
+    }
+
+    return (int) presets.size() == numPresets;
+}
+
+//==============================================================================
+
+bool PresetMorph::start(const Ek0Ka0s::Snapshot& target, double morphSeconds) noexcept
+{
+    if (fifo.getFreeSpace() == 0)
+        return false;
+
+    const auto scope = fifo.write(1);
+    requests[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = { target, morphSeconds };
+
+    return true;
+}
+
+void PresetMorph::process(Ek0Ka0s::Snapshot& params, const Ek0Ka0s::Snapshot& applied, double sampleRate, int numSamples) noexcept
+{
+    // Only the latest request counts; it starts from wherever the audio is now
+
+    const int numReady = fifo.getNumReady();
+
+    if (numReady > 0)
+    {
+        const auto scope = fifo.read(numReady);
+        const int last = scope.blockSize2 > 0 ? scope.startIndex2 + scope.blockSize2 - 1
+                                              : scope.startIndex1 + scope.blockSize1 - 1;
+
+        from = isMorphing() ? current : applied;
+        to = requests[(size_t) last].target;
+        seconds = requests[(size_t) last].seconds;
+        position = 0.0;
+    }
+
+    if (! isMorphing())
+        return;
+
+    position = seconds > 0.0 ? juce::jmin(1.0, position + numSamples / (seconds * sampleRate)) : 1.0;
+
+    const auto t = (float) position;
+
+    for (const auto& d : Ek0Ka0s::descriptors)
+    {
+        const auto i = (size_t) d.index;
+
+        current.values[i] = d.choices != nullptr ? (t < 0.5f ? from.values[i] : to.values[i])
+                                                 : from.values[i] + (to.values[i] - from.values[i]) * t;
+    }
+
+    params = current;
+}
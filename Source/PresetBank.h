@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    PresetBank keeps every preset in one versioned binary file next to the
+    settings file, shared by all instances of the plugin. The file is read on a
+    background thread and swapped in on the message thread; a name index gives
+    constant time lookup. Banks store the parameter IDs they were written with,
+    so presets survive parameters being added or reordered: missing ones take
+    their default.
+
+    Presets that older versions kept as ValueTrees in the shared settings are
+    imported the first time the bank file doesn't exist yet.
+
+    PresetMorph hands a recalled preset to the audio thread as one prebuilt
+    Snapshot, which it morphs into from wherever the parameters are over a set
+    time instead of jumping.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Ek0Ka0s.h"
+
+class PresetBank : public juce::ChangeBroadcaster
+{
+public:
+
+    struct Preset
+    {
+        juce::String name;
+        Ek0Ka0s::Snapshot values;
+    };
+
+    static constexpr int magic = 0x42504345;    // "ECPB"
+    static constexpr int version = 1;
+
+    PresetBank();
+    ~PresetBank() override;
+
+    // Message thread. Changes are announced with a change message.
+
+    int getNumPresets() const noexcept                      { return (int) presets.size(); }
+    const Preset* getPreset(int index) const noexcept;
+    int indexOf(const juce::String& name) const;            // -1 when there is none
+
+    void add(const juce::String& name, const Ek0Ka0s::Snapshot& values);   // replaces a preset of the same name
+    void remove(int index);
+
+    bool isLoaded() const noexcept                          { return loaded; }
+
+    //==============================================================================
+    // The file format, usable on any thread
+
+    static bool write(juce::OutputStream& stream, const std::vector<Preset>& presets);
+    static bool read(juce::InputStream& stream, std::vector<Preset>& presets);
+
+    static juce::File getDefaultFile();
+
+private:
+
+    class Loader;
+
+    void loadFinished(std::vector<Preset> loadedPresets, bool fileExisted);
+    void importLegacyPresets();
+    void rebuildIndex();
+    bool save() const;
+
+    juce::File file;
+    std::vector<Preset> presets;
+    juce::HashMap<juce::String, int> index;
+    bool loaded = false;
+
+    std::vector<Preset> addedBeforeLoad;        // merged into the file's presets when the load finishes
+
+    std::unique_ptr<Loader> loader;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PresetBank)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
+
+//==============================================================================
+
+class PresetMorph
+{
+public:
+
+    // Message thread: queues a morph into target. Returns false if the queue is full.
+    bool start(const Ek0Ka0s::Snapshot& target, double seconds) noexcept;
+
+    // Audio thread, once per block before the parameters are applied. While a morph
+    // runs, params is replaced by the morph; choices switch halfway through. A new
+    // morph starts from applied, the values the previous block ran with: the
+    // parameters themselves are written right after start(), so params may already
+    // hold part or all of the target.
+    void process(Ek0Ka0s::Snapshot& params, const Ek0Ka0s::Snapshot& applied, double sampleRate, int numSamples) noexcept;
+
+    bool isMorphing() const noexcept { return position < 1.0; }
+
+private:
+
+    struct Request
+    {
+        Ek0Ka0s::Snapshot target;
+        double seconds = 0.0;
+    };
+
+    static constexpr int queueSize = 4;
+
+    juce::AbstractFifo fifo { queueSize };
+    std::array<Request, queueSize> requests;
+
+    // Audio thread only
+
+    Ek0Ka0s::Snapshot from, to, current;
+    double position = 1.0, seconds = 0.0;
+};
@@ -1,30 +1,27 @@
 
 #pragma once
 
+#include "PresetBank.h"
+
 class PresetListBox   : public juce::ListBoxModel,
                         public juce::ChangeBroadcaster,
                         public juce::ChangeListener
 {
 public:
-    PresetListBox()
+    explicit PresetListBox (PresetBank& bankToShow)
+        : bank (bankToShow)
     {
-        settings->addChangeListener (this);
+        bank.addChangeListener (this);
     }
 
     ~PresetListBox() override
     {
-        settings->removeChangeListener (this);
-    }
-
-    void setPresetsNode (juce::ValueTree node)
-    {
-        presets = node;
-        sendChangeMessage();
+        bank.removeChangeListener (this);
     }
 
     int getNumRows() override
     {
-        return presets.getNumChildren();
+        return bank.getNumPresets();
     }
 
     void listBoxItemClicked (int rowNumber, const juce::MouseEvent& event) override
@@ -35,7 +32,7 @@ public:
             juce::PopupMenu menu;
             menu.addItem ("Remove", [this, rowNumber]()
             {
-                presets.removeChild (rowNumber, nullptr);
+                bank.remove (rowNumber);
             });
             menu.showMenuAsync (options);
         }
@@ -54,12 +51,12 @@ public:
         }
 
         g.setColour (juce::Colours::silver);
-        g.drawFittedText (presets.getChild (rowNumber).getProperty ("name", "foo").toString(), bounds, juce::Justification::centredLeft, 1);
+        if (auto* preset = bank.getPreset (rowNumber))
+            g.drawFittedText (preset->name, bounds, juce::Justification::centredLeft, 1);
     }
 
     void changeListenerCallback (juce::ChangeBroadcaster*) override
     {
-        presets = settings->settings.getOrCreateChildWithName ("presets", nullptr);
         // forward to ListBox
         sendChangeMessage();
     }
@@ -67,8 +64,7 @@ public:
     std::function<void(int rowNumber)> onSelectionChanged;
 
 private:
-    juce::ValueTree presets;
-    foleys::SharedApplicationSettings settings;
+    PresetBank& bank;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetListBox)
 };
\ No newline at end of file
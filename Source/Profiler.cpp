@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    Profiler.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "Profiler.h"
+
+const char* Profiler::getStageName(Stage stage) noexcept
+{
+    static constexpr const char* names[numStages] =
+    {
+        "block", "ramp", "encode", "gate", "lfo", "oversampling", "filter", "delay", "measure", "decode", "passThrough"
+    };
+
+    return names[(size_t) stage];
+}
+
+#if ECHO_CHAOS_PROFILING
+
+namespace
+{
+    // Histogram buckets: 4 per octave of nanoseconds, up to 2^32 ns
+
+    constexpr int subBuckets = 4;
+    constexpr int numBuckets = 32 * subBuckets;
+
+    int bucketFor(juce::uint32 nanoseconds) noexcept
+    {
+        if (nanoseconds < subBuckets)
+            return (int) nanoseconds;
+
+        const int octave = juce::findHighestSetBit(nanoseconds);
+        const int fraction = (int) (nanoseconds >> (octave - 2)) & (subBuckets - 1);
+        return octave * subBuckets + fraction;
+    }
+
+    double bucketUpperBound(int bucket) noexcept    // nanoseconds
+    {
+        if (bucket < subBuckets)
+            return bucket + 1;
+
+        const int octave = bucket / subBuckets;
+        return std::ldexp(1.0 + (bucket % subBuckets + 1) / (double) subBuckets, octave);
+    }
+
+    struct Histogram
+    {
+        std::array<std::atomic<juce::uint32>, numBuckets> buckets {};
+        std::atomic<juce::uint64> count { 0 }, totalNanoseconds { 0 };
+    };
+
+    struct Event
+    {
+        juce::int64 start, end;
+        juce::uint64 thread;
+        Profiler::Stage stage;
+    };
+
+    constexpr juce::uint64 ringSize = 1 << 16;     // events, a power of two
+
+    std::array<Histogram, Profiler::numStages> histograms;
+    std::array<Event, ringSize> ring;
+    std::atomic<juce::uint64> ringPosition { 0 };  // events ever written
+
+    const double ticksToNanoseconds = 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+}
+
+Profiler::ScopedTimer::ScopedTimer(Stage stageToTime) noexcept
+    : stage(stageToTime), start(juce::Time::getHighResolutionTicks())
+{
+}
+
+Profiler::ScopedTimer::~ScopedTimer() noexcept
+{
+    const auto end = juce::Time::getHighResolutionTicks();
+    const auto nanoseconds = (juce::uint32) juce::jmin(4294967295.0, (double) (end - start) * ticksToNanoseconds);
+
+    auto& histogram = histograms[(size_t) stage];
+    histogram.buckets[(size_t) bucketFor(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    // Several threads may write; each claims its own slot
+
+    const auto position = ringPosition.fetch_add(1, std::memory_order_relaxed);
+    ring[(size_t) (position & (ringSize - 1))] = { start, end, (juce::uint64) (juce::pointer_sized_int) juce::Thread::getCurrentThreadId(), stage };
+}
+
+void Profiler::reset()
+{
+    for (auto& histogram : histograms)
+    {
+        for (auto& bucket : histogram.buckets)
+            bucket = 0;
+
+        histogram.count = 0;
+        histogram.totalNanoseconds = 0;
+    }
+
+    ringPosition = 0;
+}
+
+bool Profiler::writeChromeTrace(juce::OutputStream& stream)
+{
+    // Complete ("X") events with microsecond timestamps, oldest first. Threads get
+    // small ids in order of appearance.
+
+    const auto written = ringPosition.load();
+    const auto first = written > ringSize ? written - ringSize : 0;
+    const auto origin = written > 0 ? ring[(size_t) (first & (ringSize - 1))].start : 0;
+
+    juce::Array<juce::uint64> threads;
+    bool ok = stream.writeText("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", false, false, nullptr);
+
+    for (auto position = first; position < written && ok; ++position)
+    {
+        const auto& event = ring[(size_t) (position & (ringSize - 1))];
+        threads.addIfNotAlreadyThere(event.thread);
+
+        const double start = (double) (event.start - origin) * ticksToNanoseconds * 1.0e-3;
+        const double duration = (double) (event.end - event.start) * ticksToNanoseconds * 1.0e-3;
+
+        ok = stream.writeText(juce::String(position > first ? ",\n" : "")
+                              + "{\"name\":\"" + getStageName(event.stage) + "\",\"cat\":\"dsp\",\"ph\":\"X\",\"pid\":1"
+                              + ",\"tid\":" + juce::String(threads.indexOf(event.thread) + 1)
+                              + ",\"ts\":" + juce::String(start, 3)
+                              + ",\"dur\":" + juce::String(duration, 3) + "}", false, false, nullptr);
+    }
+
+    return ok && stream.writeText("\n]}\n", false, false, nullptr);
+}
+
+juce::String Profiler::getSummary()
+{
+    juce::String summary = "stage             calls    mean us     p50 us     p90 us     p99 us     max us\n";
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto& histogram = histograms[(size_t) stage];
+        const auto count = histogram.count.load();
+
+        if (count == 0)
+            continue;
+
+        // Percentiles are the upper bounds of their buckets, within 1/4 octave
+
+        auto percentile = [&](double fraction)
+        {
+            const auto rank = (juce::uint64) std::ceil(fraction * (double) count);
+            juce::uint64 seen = 0;
+
+            for (int bucket = 0; bucket < numBuckets; ++bucket)
+                if ((seen += histogram.buckets[(size_t) bucket].load()) >= rank)
+                    return bucketUpperBound(bucket) * 1.0e-3;
+
+            return bucketUpperBound(numBuckets - 1) * 1.0e-3;
+        };
+
+        summary << juce::String(getStageName((Stage) stage)).paddedRight(' ', 14)
+                << juce::String((juce::int64) count).paddedLeft(' ', 9)
+                << juce::String((double) histogram.totalNanoseconds.load() * 1.0e-3 / (double) count, 3).paddedLeft(' ', 11)
+                << juce::String(percentile(0.50), 3).paddedLeft(' ', 11)
+                << juce::String(percentile(0.90), 3).paddedLeft(' ', 11)
+                << juce::String(percentile(0.99), 3).paddedLeft(' ', 11)
+                << juce::String(percentile(1.0), 3).paddedLeft(' ', 11) << "\n";
+    }
+
+    return summary;
+}
+
+#endif
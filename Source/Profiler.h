@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    Profiler.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    Stage level profiling of processBlock. With ECHO_CHAOS_PROFILING set to 1
+    (add it to the preprocessor definitions, the benchmark's Profile
+    configuration does), every ECHO_CHAOS_PROFILE scope adds its duration to a
+    lock-free latency histogram of its stage and records a timeline event in a
+    preallocated ring that keeps the latest events. The results can be written
+    as Chrome / Perfetto trace JSON and as a per-stage summary. With it set to
+    0 (the default) the scopes compile to nothing.
+
+    The histograms and the ring are shared by every instance in the process.
+    Read them once the audio has stopped.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef ECHO_CHAOS_PROFILING
+ #define ECHO_CHAOS_PROFILING 0
+#endif
+
+namespace Profiler
+{
+    enum Stage
+    {
+        block = 0,
+        ramp,
+        encode,
+        gate,
+        lfo,
+        oversampling,   // filter + delay, and the up and down sampling around them
+        filter,
+        delay,
+        measure,
+        decode,
+        passThrough,
+        numStages
+    };
+
+    const char* getStageName(Stage stage) noexcept;
+
+   #if ECHO_CHAOS_PROFILING
+    struct ScopedTimer
+    {
+        explicit ScopedTimer(Stage stageToTime) noexcept;
+        ~ScopedTimer() noexcept;
+
+        Stage stage;
+        juce::int64 start;
+    };
+
+    // Not while audio is running
+    void reset();
+    bool writeChromeTrace(juce::OutputStream& stream);
+    juce::String getSummary();      // calls, mean and percentiles of every stage, in microseconds
+   #else
+    struct ScopedTimer
+    {
+        explicit ScopedTimer(Stage) noexcept {}
+    };
+   #endif
+}
+
+#define ECHO_CHAOS_PROFILE(stage) const Profiler::ScopedTimer JUCE_JOIN_MACRO(profilerScope, __LINE__) (Profiler::stage)
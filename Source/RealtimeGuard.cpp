@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    RealtimeGuard.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "RealtimeGuard.h"
+
+#if ECHO_CHAOS_ASSERT_NO_ALLOCATION
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local int noAllocationDepth = 0;
+
+    // The assertion's own logging allocates; with the depth cleared while it
+    // reports, that allocation goes through instead of asserting again
+    void checkAllocation() noexcept
+    {
+        if (noAllocationDepth == 0)
+            return;
+
+        const int depth = noAllocationDepth;
+        noAllocationDepth = 0;
+
+        jassertfalse; // the audio thread just allocated
+
+        noAllocationDepth = depth;
+    }
+}
+
+RealtimeGuard::ScopedNoAllocation::ScopedNoAllocation() noexcept    { ++noAllocationDepth; }
+RealtimeGuard::ScopedNoAllocation::~ScopedNoAllocation() noexcept   { --noAllocationDepth; }
+
+// new[], the nothrow forms and the sized deletes all forward to these four
+
+void* operator new(std::size_t size)
+{
+    checkAllocation();
+
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+// Over-aligned types, such as the SIMD vectors of the engine
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    checkAllocation();
+
+    const auto align = juce::jmax((std::size_t) alignment, sizeof(void*));
+
+   #if JUCE_WINDOWS
+    if (auto* ptr = _aligned_malloc(size == 0 ? 1 : size, align))
+        return ptr;
+   #else
+    void* ptr = nullptr;
+
+    if (posix_memalign(&ptr, align, size == 0 ? 1 : size) == 0)
+        return ptr;
+   #endif
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+   #if JUCE_WINDOWS
+    _aligned_free(ptr);
+   #else
+    std::free(ptr);
+   #endif
+}
+
+#endif
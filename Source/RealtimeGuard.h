@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    RealtimeGuard.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    Debug aid for the audio thread. With ECHO_CHAOS_ASSERT_NO_ALLOCATION set to 1
+    (add it to the preprocessor definitions of a Debug build), the global
+    operator new asserts whenever it is reached inside a ScopedNoAllocation,
+    i.e. whenever processBlock allocates. With it set to 0 (the default) the
+    guard compiles to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef ECHO_CHAOS_ASSERT_NO_ALLOCATION
+ #define ECHO_CHAOS_ASSERT_NO_ALLOCATION 0
+#endif
+
+namespace RealtimeGuard
+{
+   #if ECHO_CHAOS_ASSERT_NO_ALLOCATION
+    struct ScopedNoAllocation
+    {
+        ScopedNoAllocation() noexcept;
+        ~ScopedNoAllocation() noexcept;
+    };
+   #else
+    struct ScopedNoAllocation
+    {
+        ScopedNoAllocation() noexcept {}
+    };
+   #endif
+}
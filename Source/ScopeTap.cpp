@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    ScopeTap.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "ScopeTap.h"
+
+ScopeTap::~ScopeTap()
+{
+    stopTimer();
+}
+
+void ScopeTap::prepare(int decimationFactor, float modulationScale)
+{
+    decimation = juce::jmax(1, decimationFactor);
+    decimationPhase = 0;
+    modScale = modulationScale;
+
+    ring.clear();
+    fifo.reset();
+}
+
+void ScopeTap::setScopes(foleys::MagicOscilloscope* mid, foleys::MagicOscilloscope* side)
+{
+    midScope = mid;
+    sideScope = side;
+}
+
+void ScopeTap::setEditorOpen(bool isOpen)
+{
+    if (isOpen && ring.getNumSamples() == 0)
+    {
+        ring.setSize(numChannels, ringSize);
+        drained.setSize(numChannels, ringSize);
+        ring.clear();
+        fifo.reset();
+    }
+
+    editorOpen.store(isOpen, std::memory_order_release);
+
+    if (isOpen)
+        startTimerHz(drainHz);
+    else
+        stopTimer();
+}
+
+void ScopeTap::push(const float* const* modulation, const float* const* audio, int numSamples) noexcept
+{
+    pushFrames(modulation, audio, numSamples);
+}
+
+void ScopeTap::push(const float* const* modulation, const double* const* audio, int numSamples) noexcept
+{
+    pushFrames(modulation, audio, numSamples);
+}
+
+template <typename SampleType>
+void ScopeTap::pushFrames(const float* const* modulation, const SampleType* const* audio, int numSamples) noexcept
+{
+    if (! isActive() || ring.getNumSamples() == 0)
+        return;
+
+    // Frames at positions decimationPhase, decimationPhase + decimation, ...
+
+    const int numFrames = decimationPhase < numSamples ? 1 + (numSamples - 1 - decimationPhase) / decimation : 0;
+    const int firstSample = decimationPhase;
+
+    decimationPhase = firstSample + numFrames * decimation - numSamples;
+
+    if (numFrames == 0 || fifo.getFreeSpace() < numFrames) // GUI fell behind, drop rather than wait
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numFrames, start1, size1, start2, size2);
+
+    auto copyFrames = [&](const auto* source, float* dest, float scale)
+    {
+        for (int i = 0; i < size1; ++i)
+            dest[start1 + i] = (float) source[i * decimation] * scale;
+
+        for (int i = 0; i < size2; ++i)
+            dest[start2 + i] = (float) source[(size1 + i) * decimation] * scale;
+    };
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (channel < midAudio)
+            copyFrames(modulation[channel] + firstSample, ring.getWritePointer(channel), modScale);
+        else
+            copyFrames(audio[channel - midAudio] + firstSample, ring.getWritePointer(channel), 1.f);
+    }
+
+    fifo.finishedWrite(size1 + size2);
+}
+
+void ScopeTap::timerCallback()
+{
+    const int numReady = fifo.getNumReady();
+
+    if (numReady == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        drained.copyFrom(channel, 0, ring, channel, start1, size1);
+
+        if (size2 > 0)
+            drained.copyFrom(channel, size1, ring, channel, start2, size2);
+    }
+
+    fifo.finishedRead(size1 + size2);
+
+    // Each scope gets its modulation channel first and its audio channel second
+
+    float* midChannels[] = { drained.getWritePointer(midModulation), drained.getWritePointer(midAudio) };
+    float* sideChannels[] = { drained.getWritePointer(sideModulation), drained.getWritePointer(sideAudio) };
+
+    if (midScope != nullptr)
+        midScope->pushSamples(juce::AudioBuffer<float>(midChannels, 2, size1 + size2));
+
+    if (sideScope != nullptr)
+        sideScope->pushSamples(juce::AudioBuffer<float>(sideChannels, 2, size1 + size2));
+}
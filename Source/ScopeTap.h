@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    ScopeTap.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    ScopeTap carries the values shown by the mid and side oscilloscopes from the
+    audio thread to the GUI. The audio thread writes decimated frames into a
+    preallocated single-producer/single-consumer ring once per block, and a
+    message thread timer drains the ring into the foleys oscilloscopes.
+
+    Nothing is written while no editor is open, and the ring is only allocated
+    when an editor first opens, so instances nobody looks at don't carry it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ScopeTap : private juce::Timer
+{
+public:
+
+    enum Channel
+    {
+        midModulation = 0,
+        sideModulation,
+        midAudio,
+        sideAudio,
+        numChannels
+    };
+
+    ScopeTap() = default;
+    ~ScopeTap() override;
+
+    // Message thread. Clears the ring, so never call it while the audio thread pushes.
+    void prepare(int decimationFactor, float modulationScale);
+
+    void setScopes(foleys::MagicOscilloscope* mid, foleys::MagicOscilloscope* side);
+
+    // Message thread. Starts or stops draining, and gates the audio thread pushes.
+    // The first opening allocates the ring before the pushes are let through.
+    void setEditorOpen(bool isOpen);
+
+    bool isActive() const noexcept { return editorOpen.load(std::memory_order_acquire); }
+
+    // Audio thread. modulation holds the midModulation and sideModulation channels,
+    // audio the midAudio and sideAudio ones, in the engine's sample type.
+    void push(const float* const* modulation, const float* const* audio, int numSamples) noexcept;
+    void push(const float* const* modulation, const double* const* audio, int numSamples) noexcept;
+
+private:
+
+    template <typename SampleType>
+    void pushFrames(const float* const* modulation, const SampleType* const* audio, int numSamples) noexcept;
+
+    void timerCallback() override;
+
+    static constexpr int ringSize = 8192;   // decimated frames
+    static constexpr int drainHz = 30;
+
+    juce::AbstractFifo fifo{ ringSize };
+    juce::AudioBuffer<float> ring;
+    juce::AudioBuffer<float> drained;
+
+    int decimation = 1;
+    int decimationPhase = 0;
+    float modScale = 1.f;
+
+    std::atomic<bool> editorOpen{ false };
+
+    foleys::MagicOscilloscope* midScope = nullptr;
+    foleys::MagicOscilloscope* sideScope = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeTap)
+};
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    SmootherBank.cpp
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+  ==============================================================================
+*/
+
+#include "SmootherBank.h"
+
+void SmootherBank::prepare(int smoothers, int maxBlockSize, double newSampleRate)
+{
+    numSmoothers = smoothers;
+    rowSize = maxBlockSize;
+    numSmoothing = 0;
+    sampleRate = newSampleRate;
+
+    current.assign((size_t) numSmoothers, 0.f);
+    target.assign((size_t) numSmoothers, 0.f);
+    step.assign((size_t) numSmoothers, 0.f);
+    countdown.assign((size_t) numSmoothers, 0);
+    rampLength.assign((size_t) numSmoothers, 0);
+    ramps.assign((size_t) numSmoothers, Ramp::linear);
+    isMultiplying.assign((size_t) numSmoothers, false);
+    moved.assign((size_t) numSmoothers, false);
+    rowConstant.assign((size_t) numSmoothers, std::numeric_limits<float>::quiet_NaN());
+
+    rows.calloc((size_t) numSmoothers * (size_t) rowSize);
+    indexTable.calloc((size_t) rowSize);
+
+    for (int i = 0; i < rowSize; ++i)
+        indexTable[(size_t) i] = (float) (i + 1);
+}
+
+void SmootherBank::setRamp(int index, Ramp ramp, double rampLengthInSeconds)
+{
+    ramps[(size_t) index] = ramp;
+    rampLength[(size_t) index] = juce::roundToInt(rampLengthInSeconds * sampleRate);
+    setCurrentAndTargetValue(index, target[(size_t) index]);
+}
+
+void SmootherBank::setCurrentAndTargetValue(int index, float value) noexcept
+{
+    if (countdown[(size_t) index] > 0)
+        --numSmoothing;
+
+    current[(size_t) index] = value;
+    target[(size_t) index] = value;
+    countdown[(size_t) index] = 0;
+    moved[(size_t) index] = false;
+}
+
+void SmootherBank::setTargetValue(int index, float value) noexcept
+{
+    const auto i = (size_t) index;
+
+    if (value == target[i])
+        return;
+
+    if (rampLength[i] <= 0)
+    {
+        setCurrentAndTargetValue(index, value);
+        return;
+    }
+
+    if (countdown[i] == 0)
+        ++numSmoothing;
+
+    target[i] = value;
+    countdown[i] = rampLength[i];
+
+    // Same shape as juce::SmoothedValue: the ramp restarts from wherever it is now
+
+    isMultiplying[i] = ramps[i] == Ramp::multiplicative && current[i] > 0.f && value > 0.f;
+
+    step[i] = isMultiplying[i] ? (float) std::exp((std::log((double) value) - std::log((double) current[i])) / countdown[i])
+                               : (value - current[i]) / (float) countdown[i];
+}
+
+//==============================================================================
+
+void SmootherBank::process(int numSamples) noexcept
+{
+    jassert(numSamples <= rowSize);
+
+    if (numSmoothing == 0)  // idle fast path
+    {
+        std::fill(moved.begin(), moved.end(), false);
+        return;
+    }
+
+    for (int index = 0; index < numSmoothers; ++index)
+    {
+        const auto i = (size_t) index;
+
+        moved[i] = countdown[i] > 0;
+
+        if (! moved[i])
+            continue;
+
+        if (isMultiplying[i])
+            renderMultiplicative(index, numSamples);
+        else
+            renderLinear(index, numSamples);
+
+        rowConstant[i] = std::numeric_limits<float>::quiet_NaN();
+
+        if (countdown[i] <= numSamples)
+        {
+            countdown[i] = 0;
+            current[i] = target[i];
+            --numSmoothing;
+        }
+        else
+        {
+            countdown[i] -= numSamples;
+            current[i] = row(index)[numSamples - 1];
+        }
+    }
+}
+
+void SmootherBank::renderLinear(int index, int numSamples) noexcept
+{
+    const auto i = (size_t) index;
+    const int numRamped = juce::jmin(numSamples, countdown[i]);
+    float* dest = row(index);
+
+    // current + step * (n + 1), then the target for what's left of the block
+
+    juce::FloatVectorOperations::copyWithMultiply(dest, indexTable.get(), step[i], numRamped);
+    juce::FloatVectorOperations::add(dest, current[i], numRamped);
+
+    if (numRamped == countdown[i])
+        dest[numRamped - 1] = target[i];    // land exactly on the target
+
+    if (numRamped < numSamples)
+        juce::FloatVectorOperations::fill(dest + numRamped, target[i], numSamples - numRamped);
+}
+
+void SmootherBank::renderMultiplicative(int index, int numSamples) noexcept
+{
+    const auto i = (size_t) index;
+    const int numRamped = juce::jmin(numSamples, countdown[i]);
+    const float ratio = step[i];
+    float* dest = row(index);
+
+    // Four independent chains of ratio^4, so the products don't wait on each other
+
+    float value = current[i];
+    const int head = juce::jmin(4, numRamped);
+
+    for (int n = 0; n < head; ++n)
+        dest[n] = value *= ratio;
+
+    const float ratio4 = ratio * ratio * ratio * ratio;
+
+    for (int n = head; n < numRamped; ++n)
+        dest[n] = dest[n - 4] * ratio4;
+
+    if (numRamped == countdown[i])
+        dest[numRamped - 1] = target[i];
+
+    if (numRamped < numSamples)
+        juce::FloatVectorOperations::fill(dest + numRamped, target[i], numSamples - numRamped);
+}
+
+//==============================================================================
+
+const float* SmootherBank::getValues(int index) noexcept
+{
+    const auto i = (size_t) index;
+
+    if (moved[i])
+        return row(index);
+
+    // A constant row is only refilled when its value changed
+
+    if (! (rowConstant[i] == current[i]))
+    {
+        juce::FloatVectorOperations::fill(row(index), current[i], rowSize);
+        rowConstant[i] = current[i];
+    }
+
+    return row(index);
+}
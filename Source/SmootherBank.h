@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    SmootherBank.h
+    Created: 17 Oct 2026
+    Author:  Pablo Tablas
+
+    SmootherBank holds every ramping parameter in one structure-of-arrays and
+    renders whole tiles of ramp values at once, instead of one juce::SmoothedValue
+    per parameter asked for every sample.
+
+    A smoother that is ramping gets its tile written with vector operations: a
+    linear ramp is an index table scaled and offset, a multiplicative one is four
+    independent products per step. A smoother that holds still costs nothing per
+    sample; getRamp() returns nullptr and the caller uses getCurrentValue().
+
+    Multiplicative ramps (for cutoff, time and speed, so they sweep evenly by ear)
+    fall back to linear when either end is zero or negative.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SmootherBank
+{
+public:
+
+    enum class Ramp { linear, multiplicative };
+
+    // Allocates; call from prepareToPlay. Every smoother starts linear and at zero.
+    void prepare(int numSmoothers, int maxBlockSize, double sampleRate);
+
+    void setRamp(int index, Ramp ramp, double rampLengthInSeconds);
+
+    void setCurrentAndTargetValue(int index, float value) noexcept;
+    void setTargetValue(int index, float value) noexcept;
+
+    // Renders the next numSamples (at most maxBlockSize) of every ramping smoother
+    void process(int numSamples) noexcept;
+
+    //==============================================================================
+    // After process()
+
+    // This block's values, or nullptr when the smoother didn't move during it
+    const float* getRamp(int index) const noexcept      { return moved[(size_t) index] ? row(index) : nullptr; }
+
+    // This block's values, as a constant row when the smoother didn't move
+    const float* getValues(int index) noexcept;
+
+    // Value at the end of the block
+    float getCurrentValue(int index) const noexcept     { return current[(size_t) index]; }
+    float getTargetValue(int index) const noexcept      { return target[(size_t) index]; }
+
+    bool isSmoothing(int index) const noexcept          { return countdown[(size_t) index] > 0; }
+    bool isAnySmoothing() const noexcept                { return numSmoothing > 0; }
+
+private:
+
+    float* row(int index) const noexcept { return rows.get() + (size_t) index * (size_t) rowSize; }
+
+    void renderLinear(int index, int numSamples) noexcept;
+    void renderMultiplicative(int index, int numSamples) noexcept;
+
+    int numSmoothers = 0, rowSize = 0, numSmoothing = 0;
+    double sampleRate = 44100.0;
+
+    // One entry per smoother
+
+    std::vector<float> current, target, step;   // step is an increment (linear) or a ratio (multiplicative)
+    std::vector<int> countdown, rampLength;
+    std::vector<Ramp> ramps;
+    std::vector<bool> isMultiplying;            // the ramp in flight multiplies
+    std::vector<bool> moved;                    // row holds a ramp for this block
+    std::vector<float> rowConstant;             // value a constant row was filled with, NaN when it isn't one
+
+    juce::HeapBlock<float> rows;                // numSmoothers rows of rowSize values
+    juce::HeapBlock<float> indexTable;          // 1, 2, 3... for linear ramps
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SmootherBank)
+};